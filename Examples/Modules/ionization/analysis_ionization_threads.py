@@ -0,0 +1,58 @@
+#! /usr/bin/env python
+
+# Copyright 2020 The WarpX Community
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+"""
+This script tests that the field ionization does not depend on the number of
+OpenMP threads.
+
+The input file inputs_2d_rt is run with one OpenMP thread by the test suite,
+and again by this script with four OpenMP threads (and the same domain
+decomposition). The random numbers of the ionization are drawn from streams
+keyed on the particle ids, which are given in the order of the tiles: both
+runs must therefore create the same electrons, and each ion must end up with
+the same ionization level.
+"""
+
+import glob
+import os
+import sys
+import numpy as np
+import yt
+yt.funcs.mylog.setLevel(0)
+
+def get_particles(filename, species, field=None):
+    ad = yt.load( filename ).all_data()
+    cpu = ad[species, 'particle_cpu'].v.astype(np.int64)
+    pid = ad[species, 'particle_id'].v.astype(np.int64)
+    order = np.lexsort((pid, cpu))
+    values = ad[species, field].v[order] if field else None
+    return cpu[order], pid[order], values
+
+# Plotfile of the run with one thread
+filename = sys.argv[1]
+
+# Run again with four threads
+executables = glob.glob("main2d*")
+assert(len(executables) == 1)
+threads_prefix = 'threads_plt'
+os.system("OMP_NUM_THREADS=4 ./" + executables[0] + " inputs_2d_rt"
+          + " diag1.file_prefix=" + threads_prefix)
+filename_threads = threads_prefix + filename[-5:]
+
+# Same ions, with the same ionization levels
+cpu1, id1, ilev1 = get_particles(filename, 'ions', 'particle_ionization_level')
+cpu4, id4, ilev4 = get_particles(filename_threads, 'ions', 'particle_ionization_level')
+print("Number of ions: %d, %d" %(id1.size, id4.size))
+assert np.array_equal(cpu1, cpu4) and np.array_equal(id1, id4)
+assert np.array_equal(ilev1, ilev4)
+
+# Same electrons (initial ones and ionization products)
+cpu1, id1, _ = get_particles(filename, 'electrons')
+cpu4, id4, _ = get_particles(filename_threads, 'electrons')
+print("Number of electrons: %d, %d" %(id1.size, id4.size))
+assert np.array_equal(cpu1, cpu4) and np.array_equal(id1, id4)
@@ -0,0 +1,50 @@
+#! /usr/bin/env python
+#
+# Copyright 2020 The WarpX Community
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+"""
+This script tests the persistent electrostatic solver, which solves the
+Poisson equation once for the total charge density of all species (with the
+potential of the previous step as initial guess), against the solver that
+solves it for each species separately.
+
+The input file inputs_3d_two_species is used: the expanding sphere of
+inputs_3d is made of two electron species, which have the same (zero) mean
+velocity. The simulation is run again by this script with
+warpx.do_persistent_phi=0, and the electric fields of both runs are compared.
+"""
+import glob
+import os
+import sys
+import numpy as np
+import yt
+yt.funcs.mylog.setLevel(0)
+
+tolerance = 1.e-6
+
+def get_fields(filename):
+    ds = yt.load( filename )
+    data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge,
+                            dims=ds.domain_dimensions)
+    return [ data[field].to_ndarray() for field in ['Ex', 'Ey', 'Ez'] ]
+
+# Plotfile of the persistent solver
+filename = sys.argv[1]
+E_persistent = get_fields(filename)
+
+# Run again with the per-species solver
+executables = glob.glob("main3d*")
+assert(len(executables) == 1)
+per_species_prefix = 'per_species_plt'
+os.system("./" + executables[0] + " inputs_3d_two_species warpx.do_persistent_phi=0"
+          + " diag1.file_prefix=" + per_species_prefix)
+E_per_species = get_fields(per_species_prefix + filename[-5:])
+
+for name, E1, E2 in zip(['Ex', 'Ey', 'Ez'], E_persistent, E_per_species):
+    error = np.max(np.abs(E1 - E2)) / np.max(np.abs(E2))
+    print("relative difference of %s = %s" %(name, error))
+    assert error < tolerance
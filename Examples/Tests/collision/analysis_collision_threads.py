@@ -0,0 +1,52 @@
+#! /usr/bin/env python
+
+# Copyright 2020 The WarpX Community
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+"""
+This script tests that the binary collisions do not depend on the number of
+OpenMP threads.
+
+The input file inputs_2d (electron-ion temperature relaxation, without field
+deposition) is run with one OpenMP thread and small tiles by the test suite,
+and again by this script with four OpenMP threads. The random numbers of the
+collisions are drawn from streams keyed on the cells, and the particles of
+each cell are sorted by id before they are shuffled: each particle must end
+up with exactly the same momentum in both runs.
+"""
+
+import glob
+import os
+import sys
+import numpy as np
+import yt
+yt.funcs.mylog.setLevel(0)
+
+def get_momenta(filename):
+    ad = yt.load( filename ).all_data()
+    cpu = ad['all', 'particle_cpu'].v.astype(np.int64)
+    pid = ad['all', 'particle_id'].v.astype(np.int64)
+    order = np.lexsort((pid, cpu))
+    momenta = [ ad['all', 'particle_momentum_' + d].v[order] for d in 'xyz' ]
+    return cpu[order], pid[order], momenta
+
+# Plotfile of the run with one thread
+filename = sys.argv[1]
+
+# Run again with four threads, with the same tiles
+executables = glob.glob("main2d*")
+assert(len(executables) == 1)
+threads_prefix = 'threads_plt'
+os.system("OMP_NUM_THREADS=4 ./" + executables[0] + " inputs_2d"
+          + " particles.tile_size=2 2 diag1.file_prefix=" + threads_prefix)
+
+cpu1, id1, u1 = get_momenta(filename)
+cpu4, id4, u4 = get_momenta(threads_prefix + filename[-5:])
+print("Number of particles: %d, %d" %(id1.size, id4.size))
+assert np.array_equal(cpu1, cpu4) and np.array_equal(id1, id4)
+for d, p1, p4 in zip('xyz', u1, u4):
+    print("max difference of momentum_%s: %s" %(d, np.max(np.abs(p1 - p4))))
+    assert np.array_equal(p1, p4)
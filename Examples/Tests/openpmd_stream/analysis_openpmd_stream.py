@@ -0,0 +1,50 @@
+#! /usr/bin/env python
+
+# Copyright 2020 The WarpX Community
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+"""
+This script tests the openPMD streaming output (openpmd_backend = sst).
+
+The input file inputs_3d is run by the test suite with diag2 written to
+openPMD files. This script runs the simulation again in the background with
+diag2 streamed through the ADIOS2 SST engine, reads the stream with the
+example reader Tools/PostProcessing/read_openpmd_stream.py, and checks that
+each iteration of the files is received, with the same data.
+"""
+
+import glob
+import os
+import subprocess
+import numpy as np
+import openpmd_api as io
+from read_openpmd_stream import read_stream
+
+# Iterations written to files by the run of the test suite
+series = io.Series("diags/diag2/openpmd_%T.bp", io.Access_Type.read_only)
+file_data = {}
+for index, iteration in series.iterations.items():
+    file_data[index] = iteration.meshes['E']['x'].load_chunk()
+series.flush()
+del series
+
+# Run again in the background, streaming diag2
+executables = glob.glob("main3d*")
+assert(len(executables) == 1)
+writer = subprocess.Popen(["./" + executables[0], "inputs_3d",
+                           "diag1.file_prefix=stream_plt",
+                           "diag2.file_prefix=diags/stream",
+                           "diag2.openpmd_backend=sst"],
+                          env=dict(os.environ, OMP_NUM_THREADS="1"))
+
+stream_data = dict(read_stream("diags/stream/openpmd.sst"))
+assert writer.wait() == 0
+
+print("Iterations in files : " + str(sorted(file_data.keys())))
+print("Iterations streamed : " + str(sorted(stream_data.keys())))
+assert sorted(stream_data.keys()) == sorted(file_data.keys())
+for index in file_data:
+    assert np.array_equal(stream_data[index], file_data[index])
@@ -0,0 +1,100 @@
+#! /usr/bin/env python
+
+# Copyright 2020 The WarpX Community
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+# This script tests the particle merging.
+# The setup is a uniform plasma of electrons and photons, with 64 particles
+# per cell, which are neither pushed nor deposited: only the merging, done
+# at the end of the second step, changes them.
+# The plotfiles of the first step (before the merging) and of the second
+# step (after the merging) are compared:
+# - the number of particles shall decrease: with one momentum-space bin, each
+#   cell shall contain merging_target_ppc electrons; with n_bins bins along each
+#   direction, each cell shall contain at most merging_target_ppc photons plus
+#   2 photons per bin,
+# - the total weight (hence charge) and momentum shall be conserved,
+# and the particle energy of the reduced diagnostics, and of the plotfiles,
+# shall be conserved, for the electrons (massive) and the photons.
+
+# Possible running time: ~ 2 s
+
+import sys
+import re
+import yt
+import numpy as np
+import scipy.constants as scc
+
+tolerance = 1.e-10
+
+# Merging parameters of inputs_3d
+max_ppc = 16
+target_ppc = 8
+n_bins = {'electrons': 1, 'photons': 2}
+n_cell = 8
+prob_lo = -1.
+dx = 2./n_cell
+
+fn_after = sys.argv[1]
+prefix, step = re.match("(.*?)([0-9]+)$", fn_after).groups()
+fn_before = prefix + str(int(step)-1).zfill(len(step))
+
+def get_totals(fn, species, mass):
+    ad = yt.load(fn).all_data()
+    px = ad[species,'particle_momentum_x'].to_ndarray()
+    py = ad[species,'particle_momentum_y'].to_ndarray()
+    pz = ad[species,'particle_momentum_z'].to_ndarray()
+    w  = ad[species,'particle_weight'].to_ndarray()
+    p = np.sqrt(px**2+py**2+pz**2)
+    if mass > 0.:
+        E = np.sum( (np.sqrt(p**2*scc.c**2+mass**2*scc.c**4)-mass*scc.c**2)*w )
+    else:
+        E = np.sum( p*scc.c*w )
+    P = np.array([np.sum(px*w), np.sum(py*w), np.sum(pz*w)])
+    return w.size, np.sum(w), P, np.sum(p*w), E
+
+def get_ppc(fn, species):
+    ad = yt.load(fn).all_data()
+    index = np.zeros(ad[species,'particle_weight'].size, dtype=np.int64)
+    for axis in ['x', 'y', 'z']:
+        x = ad[species,'particle_position_'+axis].to_ndarray()
+        i = np.floor((x - prob_lo)/dx).astype(np.int64)
+        assert(np.all(i >= 0) and np.all(i < n_cell))
+        index = index*n_cell + i
+    return np.bincount(index, minlength=n_cell**3)
+
+# Particle energy of the reduced diagnostics, before and after the merging
+EPdata = np.genfromtxt("./diags/reducedfiles/EP.txt")
+
+for i_s, (species, mass) in enumerate([('electrons', scc.m_e), ('photons', 0.)]):
+    n0, w0, P0, p0, E0 = get_totals(fn_before, species, mass)
+    n1, w1, P1, p1, E1 = get_totals(fn_after, species, mass)
+    EP0 = EPdata[0][3+i_s]
+    EP1 = EPdata[-1][3+i_s]
+
+    print(species + ': number of particles:', n0, '->', n1)
+    print(species + ': relative error on the weight:', abs(w1-w0)/w0)
+    print(species + ': relative error on the momentum:', np.max(np.abs(P1-P0))/p0)
+    print(species + ': relative error on the energy (plotfiles):', abs(E1-E0)/E0)
+    print(species + ': relative error on the energy (reduced diags):', abs(EP1-EP0)/EP0)
+    print('tolerance:', tolerance)
+
+    assert(n1 < n0/2)
+    assert(abs(w1-w0) < tolerance*w0)
+    assert(np.max(np.abs(P1-P0)) < tolerance*p0)
+    assert(abs(E1-E0) < tolerance*E0)
+    assert(abs(EP1-EP0) < tolerance*EP0)
+
+    # Number of particles per cell, before and after the merging
+    ppc0 = get_ppc(fn_before, species)
+    ppc1 = get_ppc(fn_after, species)
+    max_ppc1 = target_ppc + 2*n_bins[species]**3
+    print(species + ': particles per cell:', np.min(ppc0), '->', np.min(ppc1), '-', np.max(ppc1))
+    assert(np.all(ppc0 > max_ppc))
+    if n_bins[species] == 1:
+        assert(np.all(ppc1 == target_ppc))
+    else:
+        assert(np.all(ppc1 <= max_ppc1))
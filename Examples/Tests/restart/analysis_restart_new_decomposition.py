@@ -0,0 +1,72 @@
+#! /usr/bin/env python
+
+# Copyright 2020 The WarpX Community
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+"""
+This script tests the restart with a new domain decomposition
+(amr.restart_new_decomposition = 1).
+
+The input file inputs_2d (with mesh refinement and PML) is run on 2 MPI ranks
+by the test suite, and writes a checkpoint at step 10. This script restarts
+from this checkpoint on 3 MPI ranks with a smaller amr.max_grid_size, so that
+the base grids and the refined patch are chopped differently, and checks that
+the fields and the particles at step 20 are the same as in the run without
+restart (up to round-off errors, since the currents are summed in a different
+order).
+"""
+
+import glob
+import os
+import sys
+import numpy as np
+import yt
+yt.funcs.mylog.setLevel(0)
+
+tolerance = 1.e-9
+
+# Plotfile of the run without restart
+filename = sys.argv[1]
+
+# Restart from the checkpoint at step 10, on a different number of MPI ranks
+executables = glob.glob("main2d*")
+assert(len(executables) == 1)
+restart_prefix = 'restart_plt'
+os.system("mpiexec -n 3 ./" + executables[0] + " inputs_2d"
+          + " amr.restart=chk00010 amr.restart_new_decomposition=1"
+          + " amr.max_grid_size=16 diag1.file_prefix=" + restart_prefix)
+filename_restart = restart_prefix + filename[-5:]
+
+ds = yt.load( filename )
+ds_restart = yt.load( filename_restart )
+
+# Fields, on the base level
+ad0 = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+ad0_restart = ds_restart.covering_grid(level=0, left_edge=ds_restart.domain_left_edge,
+                                       dims=ds_restart.domain_dimensions)
+for field in ['Ex', 'Ey', 'Ez', 'Bx', 'By', 'Bz', 'jx', 'jy', 'jz']:
+    F = ad0[field].v
+    F_restart = ad0_restart[field].v
+    error = np.max(np.abs(F - F_restart)) / np.max(np.abs(F))
+    print(field + " relative error: %s" %error)
+    assert( error < tolerance )
+
+# Particles, sorted by (cpu, id)
+ad = ds.all_data()
+ad_restart = ds_restart.all_data()
+def sorted_values(ad, field):
+    cpu = ad['electrons', 'particle_cpu'].v.astype(np.int64)
+    pid = ad['electrons', 'particle_id'].v.astype(np.int64)
+    return ad['electrons', field].v[np.lexsort((pid, cpu))]
+for field in ['particle_id', 'particle_cpu']:
+    assert np.array_equal(sorted_values(ad, field), sorted_values(ad_restart, field))
+for field in ['particle_position_x', 'particle_position_y',
+              'particle_momentum_x', 'particle_momentum_z']:
+    v = sorted_values(ad, field)
+    v_restart = sorted_values(ad_restart, field)
+    error = np.max(np.abs(v - v_restart)) / np.max(np.abs(v))
+    print(field + " relative error: %s" %error)
+    assert( error < tolerance )
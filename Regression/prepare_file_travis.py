@@ -120,6 +120,9 @@ if ci_rz_or_nompi:
 if ci_qed:
     test_blocks = select_tests(test_blocks, ['QED=TRUE'], True)
 
+if not ci_openpmd:
+    test_blocks = select_tests(test_blocks, ['USE_OPENPMD=TRUE'], False)
+
 # - Add the selected test blocks to the text
 text = text + '\n' + '\n'.join(test_blocks)
 
@@ -88,6 +88,23 @@ namespace
         std::fill(sigma_star.begin()+(olo-sslo), sigma_star.begin()+(ohi+1-sslo), 0.0);
         std::fill(sigma_star_cumsum.begin()+(olo-sslo), sigma_star_cumsum.begin()+(ohi+1-sslo), 0.0);
     }
+
+    // Reads a PML field from a checkpoint. The E fields of the checkpoints
+    // written when they always had 3 split components have one more component
+    // than the E fields without div(E) cleaning: this last component, which
+    // is always zero in that case, is dropped.
+    static void ReadPMLField (MultiFab& mf, const std::string& name)
+    {
+        if (VisMF(name).nComp() == mf.nComp()) {
+            VisMF::Read(mf, name);
+        } else {
+            MultiFab mf_read;
+            VisMF::Read(mf_read, name);
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mf_read.nComp() > mf.nComp(),
+                "PML checkpoint " + name + " has fewer components than expected");
+            mf.ParallelCopy(mf_read, 0, 0, mf.nComp(), mf_read.nGrowVect(), mf.nGrowVect());
+        }
+    }
 }
 
 SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int ncell, int delta)
@@ -373,7 +390,7 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& /*grid_dm*/,
           Real dt, int nox_fft, int noy_fft, int noz_fft, bool do_nodal,
 #endif
           int do_dive_cleaning, int do_moving_window,
-          int /*pml_has_particles*/, int do_pml_in_domain,
+          int pml_has_particles, int do_pml_in_domain,
           const amrex::IntVect do_pml_Lo, const amrex::IntVect do_pml_Hi)
     : m_geom(geom),
       m_cgeom(cgeom)
@@ -436,12 +453,17 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& /*grid_dm*/,
     ngf = ngFFT;
 #endif
 
+    // Only store the split components that are actually updated:
+    // the third split component of E (e.g. Exx) is only driven by grad(F),
+    // and the PML current is only needed when particles enter the PML
+    const int ncomp_E = (do_dive_cleaning) ? 3 : 2;
+
     pml_E_fp[0].reset( new MultiFab( amrex::convert( ba,
-        WarpX::GetInstance().getEfield_fp(0,0).ixType().toIntVect() ), dm, 3, nge ) );
+        WarpX::GetInstance().getEfield_fp(0,0).ixType().toIntVect() ), dm, ncomp_E, nge ) );
     pml_E_fp[1].reset( new MultiFab( amrex::convert( ba,
-        WarpX::GetInstance().getEfield_fp(0,1).ixType().toIntVect() ), dm, 3, nge ) );
+        WarpX::GetInstance().getEfield_fp(0,1).ixType().toIntVect() ), dm, ncomp_E, nge ) );
     pml_E_fp[2].reset( new MultiFab( amrex::convert( ba,
-        WarpX::GetInstance().getEfield_fp(0,2).ixType().toIntVect() ), dm, 3, nge ) );
+        WarpX::GetInstance().getEfield_fp(0,2).ixType().toIntVect() ), dm, ncomp_E, nge ) );
     pml_B_fp[0].reset( new MultiFab( amrex::convert( ba,
         WarpX::GetInstance().getBfield_fp(0,0).ixType().toIntVect() ), dm, 2, ngb ) );
     pml_B_fp[1].reset( new MultiFab( amrex::convert( ba,
@@ -457,15 +479,18 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& /*grid_dm*/,
     pml_B_fp[1]->setVal(0.0);
     pml_B_fp[2]->setVal(0.0);
 
-    pml_j_fp[0].reset( new MultiFab( amrex::convert( ba,
-        WarpX::GetInstance().getcurrent_fp(0,0).ixType().toIntVect() ), dm, 1, ngb ) );
-    pml_j_fp[1].reset( new MultiFab( amrex::convert( ba,
-        WarpX::GetInstance().getcurrent_fp(0,1).ixType().toIntVect() ), dm, 1, ngb ) );
-    pml_j_fp[2].reset( new MultiFab( amrex::convert( ba,
-        WarpX::GetInstance().getcurrent_fp(0,2).ixType().toIntVect() ), dm, 1, ngb ) );
-    pml_j_fp[0]->setVal(0.0);
-    pml_j_fp[1]->setVal(0.0);
-    pml_j_fp[2]->setVal(0.0);
+    if (pml_has_particles)
+    {
+        pml_j_fp[0].reset( new MultiFab( amrex::convert( ba,
+            WarpX::GetInstance().getcurrent_fp(0,0).ixType().toIntVect() ), dm, 1, ngb ) );
+        pml_j_fp[1].reset( new MultiFab( amrex::convert( ba,
+            WarpX::GetInstance().getcurrent_fp(0,1).ixType().toIntVect() ), dm, 1, ngb ) );
+        pml_j_fp[2].reset( new MultiFab( amrex::convert( ba,
+            WarpX::GetInstance().getcurrent_fp(0,2).ixType().toIntVect() ), dm, 1, ngb ) );
+        pml_j_fp[0]->setVal(0.0);
+        pml_j_fp[1]->setVal(0.0);
+        pml_j_fp[2]->setVal(0.0);
+    }
 
     if (do_dive_cleaning)
     {
@@ -512,11 +537,11 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& /*grid_dm*/,
         DistributionMapping cdm{cba};
 
         pml_E_cp[0].reset( new MultiFab( amrex::convert( cba,
-            WarpX::GetInstance().getEfield_cp(1,0).ixType().toIntVect() ), cdm, 3, nge ) );
+            WarpX::GetInstance().getEfield_cp(1,0).ixType().toIntVect() ), cdm, ncomp_E, nge ) );
         pml_E_cp[1].reset( new MultiFab( amrex::convert( cba,
-            WarpX::GetInstance().getEfield_cp(1,1).ixType().toIntVect() ), cdm, 3, nge ) );
+            WarpX::GetInstance().getEfield_cp(1,1).ixType().toIntVect() ), cdm, ncomp_E, nge ) );
         pml_E_cp[2].reset( new MultiFab( amrex::convert( cba,
-            WarpX::GetInstance().getEfield_cp(1,2).ixType().toIntVect() ), cdm, 3, nge ) );
+            WarpX::GetInstance().getEfield_cp(1,2).ixType().toIntVect() ), cdm, ncomp_E, nge ) );
         pml_B_cp[0].reset( new MultiFab( amrex::convert( cba,
             WarpX::GetInstance().getBfield_cp(1,0).ixType().toIntVect() ), cdm, 2, ngb ) );
         pml_B_cp[1].reset( new MultiFab( amrex::convert( cba,
@@ -537,15 +562,18 @@ PML::PML (const BoxArray& grid_ba, const DistributionMapping& /*grid_dm*/,
             pml_F_cp->setVal(0.0);
 
         }
-        pml_j_cp[0].reset( new MultiFab( amrex::convert( cba,
-            WarpX::GetInstance().getcurrent_cp(1,0).ixType().toIntVect() ), cdm, 1, ngb ) );
-        pml_j_cp[1].reset( new MultiFab( amrex::convert( cba,
-            WarpX::GetInstance().getcurrent_cp(1,1).ixType().toIntVect() ), cdm, 1, ngb ) );
-        pml_j_cp[2].reset( new MultiFab( amrex::convert( cba,
-            WarpX::GetInstance().getcurrent_cp(1,2).ixType().toIntVect() ), cdm, 1, ngb ) );
-        pml_j_cp[0]->setVal(0.0);
-        pml_j_cp[1]->setVal(0.0);
-        pml_j_cp[2]->setVal(0.0);
+        if (pml_has_particles)
+        {
+            pml_j_cp[0].reset( new MultiFab( amrex::convert( cba,
+                WarpX::GetInstance().getcurrent_cp(1,0).ixType().toIntVect() ), cdm, 1, ngb ) );
+            pml_j_cp[1].reset( new MultiFab( amrex::convert( cba,
+                WarpX::GetInstance().getcurrent_cp(1,1).ixType().toIntVect() ), cdm, 1, ngb ) );
+            pml_j_cp[2].reset( new MultiFab( amrex::convert( cba,
+                WarpX::GetInstance().getcurrent_cp(1,2).ixType().toIntVect() ), cdm, 1, ngb ) );
+            pml_j_cp[0]->setVal(0.0);
+            pml_j_cp[1]->setVal(0.0);
+            pml_j_cp[2]->setVal(0.0);
+        }
 
         if (do_pml_in_domain){
             sigba_cp.reset(new MultiSigmaBox(cba, cdm, grid_cba_reduced, cgeom->CellSize(), ncell, delta));
@@ -995,22 +1023,22 @@ PML::Restart (const std::string& dir)
 {
     if (pml_E_fp[0])
     {
-        VisMF::Read(*pml_E_fp[0], dir+"_Ex_fp");
-        VisMF::Read(*pml_E_fp[1], dir+"_Ey_fp");
-        VisMF::Read(*pml_E_fp[2], dir+"_Ez_fp");
-        VisMF::Read(*pml_B_fp[0], dir+"_Bx_fp");
-        VisMF::Read(*pml_B_fp[1], dir+"_By_fp");
-        VisMF::Read(*pml_B_fp[2], dir+"_Bz_fp");
+        ReadPMLField(*pml_E_fp[0], dir+"_Ex_fp");
+        ReadPMLField(*pml_E_fp[1], dir+"_Ey_fp");
+        ReadPMLField(*pml_E_fp[2], dir+"_Ez_fp");
+        ReadPMLField(*pml_B_fp[0], dir+"_Bx_fp");
+        ReadPMLField(*pml_B_fp[1], dir+"_By_fp");
+        ReadPMLField(*pml_B_fp[2], dir+"_Bz_fp");
     }
 
     if (pml_E_cp[0])
     {
-        VisMF::Read(*pml_E_cp[0], dir+"_Ex_cp");
-        VisMF::Read(*pml_E_cp[1], dir+"_Ey_cp");
-        VisMF::Read(*pml_E_cp[2], dir+"_Ez_cp");
-        VisMF::Read(*pml_B_cp[0], dir+"_Bx_cp");
-        VisMF::Read(*pml_B_cp[1], dir+"_By_cp");
-        VisMF::Read(*pml_B_cp[2], dir+"_Bz_cp");
+        ReadPMLField(*pml_E_cp[0], dir+"_Ex_cp");
+        ReadPMLField(*pml_E_cp[1], dir+"_Ey_cp");
+        ReadPMLField(*pml_E_cp[2], dir+"_Ez_cp");
+        ReadPMLField(*pml_B_cp[0], dir+"_Bx_cp");
+        ReadPMLField(*pml_B_cp[1], dir+"_By_cp");
+        ReadPMLField(*pml_B_cp[2], dir+"_Bz_cp");
     }
 }
 
@@ -46,6 +46,12 @@ WarpX::DampPML (int lev, PatchType patch_type)
 
     WARPX_PROFILE("WarpX::DampPML()");
 
+    // The PML fields are exchanged with the regular fields in FillBoundary
+    const int patch = static_cast<int>(patch_type);
+    guard_cells.SetStale(guardCellManager::FieldType::E, lev, patch);
+    guard_cells.SetStale(guardCellManager::FieldType::B, lev, patch);
+    guard_cells.SetStale(guardCellManager::FieldType::F, lev, patch);
+
     if (pml[lev]->ok())
     {
         const auto& pml_E = (patch_type == PatchType::fine) ? pml[lev]->GetE_fp() : pml[lev]->GetE_cp();
@@ -96,19 +102,24 @@ WarpX::DampPML (int lev, PatchType patch_type)
             int const y_lo = 0;
             int const z_lo = sigba[mfi].sigma_fac[1].lo();
 #endif
+            // Without div(E) cleaning, the split E fields only have 2 components
+            bool const dive_cleaning = (pml_E[0]->nComp() > 2);
 
             amrex::ParallelFor(tex, tey, tez,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) {
                 warpx_damp_pml_ex(i,j,k,pml_Exfab,sigma_fac_y,sigma_fac_z,
-                                  sigma_star_fac_x,x_lo,y_lo,z_lo);
+                                  sigma_star_fac_x,x_lo,y_lo,z_lo,
+                                  dive_cleaning);
             },
             [=] AMREX_GPU_DEVICE (int i, int j, int k) {
                 warpx_damp_pml_ey(i,j,k,pml_Eyfab,sigma_fac_z,sigma_fac_x,
-                                  sigma_star_fac_y,x_lo,y_lo,z_lo);
+                                  sigma_star_fac_y,x_lo,y_lo,z_lo,
+                                  dive_cleaning);
             },
             [=] AMREX_GPU_DEVICE (int i, int j, int k) {
                 warpx_damp_pml_ez(i,j,k,pml_Ezfab,sigma_fac_x,sigma_fac_y,
-                                  sigma_star_fac_z,x_lo,y_lo,z_lo);
+                                  sigma_star_fac_z,x_lo,y_lo,z_lo,
+                                  dive_cleaning);
             });
 
             amrex::ParallelFor(tbx, tby, tbz,
@@ -172,6 +183,8 @@ WarpX::DampJPML (int lev, PatchType patch_type)
     {
 
         const auto& pml_j = (patch_type == PatchType::fine) ? pml[lev]->Getj_fp() : pml[lev]->Getj_cp();
+        // The PML current is only allocated when particles enter the PML
+        if (!pml_j[0]) return;
         const auto& sigba = (patch_type == PatchType::fine) ? pml[lev]->GetMultiSigmaBox_fp()
                                                             : pml[lev]->GetMultiSigmaBox_cp();
 
@@ -0,0 +1,82 @@
+/* Copyright 2020 The WarpX Community
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "AsyncFlush.H"
+#include "Utils/WarpXProfilerWrapper.H"
+
+#include <AMReX_AsyncOut.H>
+#include <AMReX_BLassert.H>
+#include <AMReX_ParmParse.H>
+
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+    /** Maximum number of snapshots being written while the next one is packed */
+    int max_in_flight = 1;
+    /** Number of snapshots submitted to the I/O thread, by this rank */
+    int n_submitted = 0;
+    /** Number of snapshots completed by the I/O thread, for this rank */
+    int n_completed = 0;
+    /** Protects n_completed, which is written by the I/O thread */
+    std::mutex completed_mutex;
+    /** Notified by the I/O thread when a snapshot is completed */
+    std::condition_variable completed_cv;
+
+    void WaitUntilInFlightBelow (int n)
+    {
+        std::unique_lock<std::mutex> lock(completed_mutex);
+        completed_cv.wait(lock, [n] () { return n_submitted - n_completed < n; });
+    }
+}
+
+bool
+AsyncFlush::Enabled ()
+{
+    return amrex::AsyncOut::UseAsyncOut();
+}
+
+void
+AsyncFlush::ReadParameters ()
+{
+    amrex::ParmParse pp("diagnostics");
+    pp.query("async_max_in_flight", max_in_flight);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(max_in_flight >= 1,
+        "diagnostics.async_max_in_flight must be at least 1");
+}
+
+void
+AsyncFlush::BeginSnapshot ()
+{
+    if (!Enabled()) return;
+    WARPX_PROFILE("AsyncFlush::BeginSnapshot()");
+    WaitUntilInFlightBelow(max_in_flight);
+}
+
+void
+AsyncFlush::EndSnapshot ()
+{
+    if (!Enabled()) return;
+    ++n_submitted;
+    // The I/O thread executes the tasks in order, so this runs once
+    // the data of this snapshot has been written.
+    amrex::AsyncOut::Submit([] () {
+        {
+            std::lock_guard<std::mutex> lock(completed_mutex);
+            ++n_completed;
+        }
+        completed_cv.notify_all();
+    });
+}
+
+void
+AsyncFlush::Drain ()
+{
+    if (!Enabled()) return;
+    WARPX_PROFILE("AsyncFlush::Drain()");
+    WaitUntilInFlightBelow(1);
+}
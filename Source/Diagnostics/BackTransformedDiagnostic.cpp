@@ -12,6 +12,8 @@
 #include "SliceDiagnostic.H"
 #include "WarpX.H"
 
+#include <cmath>
+
 using namespace amrex;
 
 #ifdef WARPX_USE_HDF5
@@ -341,16 +343,18 @@ namespace
     }
 
     /*
-      Write the only component in the multifab to the dataset given by field_name.
-      Uses hdf5-parallel.
+      Write the components of the multifab that lie in the given region to the
+      datasets given by field_paths (one dataset per component). Uses
+      hdf5-parallel: the file is opened once for all components and each
+      hyperslab is written with a collective transfer.
     */
-    void output_write_field(const std::string& file_path,
-                            const std::string& field_path,
-                            const MultiFab& mf, const int comp,
-                            const int lo_x, const int lo_y, const int lo_z)
+    void output_write_fields(const std::string& file_path,
+                             const std::vector<std::string>& field_paths,
+                             const MultiFab& mf, const Box& region,
+                             const int lo_x, const int lo_y, const int lo_z)
     {
 
-        WARPX_PROFILE("output_write_field");
+        WARPX_PROFILE("output_write_fields");
 
         MPI_Comm comm = MPI_COMM_WORLD;
         MPI_Info info = MPI_INFO_NULL;
@@ -361,27 +365,13 @@ namespace
         hid_t pa_plist = H5Pcreate(H5P_FILE_ACCESS);
         H5Pset_fapl_mpio(pa_plist, comm, info);
 
-        // Open the file, and the group.
+        // Open the file once for all the components.
         hid_t file = H5Fopen(file_path.c_str(), H5F_ACC_RDWR, pa_plist);
-        // Open the field dataset.
-        hid_t dataset = H5Dopen(file, field_path.c_str(), H5P_DEFAULT);
-
-        // Make sure the dataset is there.
-        if (dataset < 0)
-        {
-            amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
-                         ". Count not find dataset " + field_path + "\n");
-        }
-
-        // Grab the dataspace of the field dataset from file.
-        hid_t file_dataspace = H5Dget_space(dataset);
 
         // Create collective io prop list.
         hid_t collective_plist = H5Pcreate(H5P_DATASET_XFER);
-        H5Pset_dxpl_mpio(collective_plist, H5FD_MPIO_INDEPENDENT);
+        H5Pset_dxpl_mpio(collective_plist, H5FD_MPIO_COLLECTIVE);
 
-        // Iterate over Fabs, select matching hyperslab and write.
-        hid_t status;
         // slab lo index and shape.
 #if (AMREX_SPACEDIM == 3)
         hsize_t slab_offsets[3], slab_dims[3];
@@ -395,67 +385,109 @@ namespace
         shift[0] = lo_x;
         shift[1] = lo_z;
 #endif
-        hid_t slab_dataspace;
-
-        int write_count = 0;
-
-        std::vector<Real> transposed_data;
 
+        // The boxes of mf owned by this rank that intersect the region.
+        Vector<Box> local_boxes;
+        Vector<int> local_index;
         for (MFIter mfi(mf); mfi.isValid(); ++mfi)
         {
-            const Box& box = mfi.validbox();
-            const int *lo_vec = box.loVect();
-            const int *hi_vec = box.hiVect();
-
-            transposed_data.resize(box.numPts(), 0.0);
-
-            // Set slab offset and shape.
-            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
-            {
-                AMREX_ASSERT(lo_vec[idim] >= 0);
-                AMREX_ASSERT(hi_vec[idim] > lo_vec[idim]);
-                slab_offsets[idim] = lo_vec[idim] - shift[idim];
-                slab_dims[idim] = hi_vec[idim] - lo_vec[idim] + 1;
+            const Box box = mfi.validbox() & region;
+            if (box.ok()) {
+                local_boxes.push_back(box);
+                local_index.push_back(mfi.index());
             }
+        }
 
-            int cnt = 0;
-            AMREX_D_TERM(
-                         for (int i = lo_vec[0]; i <= hi_vec[0]; ++i),
-                         for (int j = lo_vec[1]; j <= hi_vec[1]; ++j),
-                         for (int k = lo_vec[2]; k <= hi_vec[2]; ++k))
-                transposed_data[cnt++] = mf[mfi](IntVect(AMREX_D_DECL(i, j, k)), comp);
+        // Collective writes must be issued by all the ranks the same number
+        // of times: ranks with fewer boxes take part with an empty selection.
+        int nwrites = local_boxes.size();
+        ParallelDescriptor::ReduceIntMax(nwrites);
 
-            // Create the slab space.
-            slab_dataspace = H5Screate_simple(AMREX_SPACEDIM, slab_dims, NULL);
+        std::vector<Real> transposed_data;
 
-            // Select the hyperslab matching this fab.
-            status = H5Sselect_hyperslab(file_dataspace, H5S_SELECT_SET,
-                                         slab_offsets, NULL, slab_dims, NULL);
-            if (status < 0)
+        for (int comp = 0; comp < static_cast<int>(field_paths.size()); ++comp)
+        {
+            // Open the field dataset.
+            hid_t dataset = H5Dopen(file, field_paths[comp].c_str(), H5P_DEFAULT);
+
+            // Make sure the dataset is there.
+            if (dataset < 0)
             {
                 amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
-                             " could not select hyperslab.\n");
+                             ". Count not find dataset " + field_paths[comp] + "\n");
             }
 
-            // Write this pencil.
-            status = H5Dwrite(dataset, H5T_NATIVE_DOUBLE, slab_dataspace,
-                              file_dataspace, collective_plist, transposed_data.data());
-            if (status < 0)
+            // Grab the dataspace of the field dataset from file.
+            hid_t file_dataspace = H5Dget_space(dataset);
+
+            hid_t status;
+            for (int iwrite = 0; iwrite < nwrites; ++iwrite)
             {
-                amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
-                             " could not write hyperslab.\n");
+                hid_t slab_dataspace;
+                if (iwrite < static_cast<int>(local_boxes.size()))
+                {
+                    const Box& box = local_boxes[iwrite];
+                    const int *lo_vec = box.loVect();
+                    const int *hi_vec = box.hiVect();
+
+                    transposed_data.resize(box.numPts(), 0.0);
+
+                    // Set slab offset and shape.
+                    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
+                    {
+                        AMREX_ASSERT(lo_vec[idim] - shift[idim] >= 0);
+                        slab_offsets[idim] = lo_vec[idim] - shift[idim];
+                        slab_dims[idim] = hi_vec[idim] - lo_vec[idim] + 1;
+                    }
+
+                    const FArrayBox& fab = mf[local_index[iwrite]];
+                    int cnt = 0;
+                    AMREX_D_TERM(
+                                 for (int i = lo_vec[0]; i <= hi_vec[0]; ++i),
+                                 for (int j = lo_vec[1]; j <= hi_vec[1]; ++j),
+                                 for (int k = lo_vec[2]; k <= hi_vec[2]; ++k))
+                        transposed_data[cnt++] = fab(IntVect(AMREX_D_DECL(i, j, k)), comp);
+
+                    // Create the slab space.
+                    slab_dataspace = H5Screate_simple(AMREX_SPACEDIM, slab_dims, NULL);
+
+                    // Select the hyperslab matching this fab.
+                    status = H5Sselect_hyperslab(file_dataspace, H5S_SELECT_SET,
+                                                 slab_offsets, NULL, slab_dims, NULL);
+                    if (status < 0)
+                    {
+                        amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
+                                     " could not select hyperslab.\n");
+                    }
+                }
+                else
+                {
+                    // Nothing left to write on this rank: empty selection.
+                    if (transposed_data.empty()) transposed_data.resize(1, 0.0);
+                    hsize_t one = 1;
+                    slab_dataspace = H5Screate_simple(1, &one, NULL);
+                    H5Sselect_none(slab_dataspace);
+                    H5Sselect_none(file_dataspace);
+                }
+
+                // Write this pencil.
+                status = H5Dwrite(dataset, H5T_NATIVE_DOUBLE, slab_dataspace,
+                                  file_dataspace, collective_plist, transposed_data.data());
+                if (status < 0)
+                {
+                    amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
+                                 " could not write hyperslab.\n");
+                }
+
+                H5Sclose(slab_dataspace);
             }
 
-            H5Sclose(slab_dataspace);
-            write_count++;
+            H5Sclose(file_dataspace);
+            H5Dclose(dataset);
         }
 
-        ParallelDescriptor::Barrier();
-
         // Close HDF5 resources.
         H5Pclose(collective_plist);
-        H5Sclose(file_dataspace);
-        H5Dclose(dataset);
         H5Fclose(file);
         H5Pclose(pa_plist);
     }
@@ -715,24 +747,38 @@ void BackTransformedDiagnostic::Flush(const Geometry& /*geom*/)
                 buff_box.setSmall(m_boost_direction_, lo);
                 buff_box.setBig(m_boost_direction_, hi);
 
-                BoxArray buff_ba(buff_box);
-                buff_ba.maxSize(m_max_box_size_);
-                DistributionMapping buff_dm(buff_ba);
-
                 const int ncomp = m_LabFrameDiags_[i]->m_data_buffer_->nComp();
 
+#ifdef WARPX_USE_HDF5
+                // Write the filled part of the buffer directly, without copying
+                // it to a temporary MultiFab.
+                const std::vector<std::string> field_paths(
+                    m_mesh_field_names.begin(), m_mesh_field_names.begin() + ncomp);
+                output_write_fields(m_LabFrameDiags_[i]->m_file_name, field_paths,
+                                    *m_LabFrameDiags_[i]->m_data_buffer_, buff_box,
+                                    lbound(buff_box).x, lbound(buff_box).y,
+                                    lbound(buff_box).z);
+#else
+                // The temporary MultiFab holding the filled part of the buffer
+                // keeps the boxes on the ranks that own them in the buffer, so
+                // that the copy below is local.
+                BoxList buff_bl;
+                Vector<int> buff_pmap;
+                for (int ibox = 0; ibox < ba.size(); ++ibox) {
+                    const Box b = ba[ibox] & buff_box;
+                    if (b.ok()) {
+                        buff_bl.push_back(b);
+                        buff_pmap.push_back(
+                            m_LabFrameDiags_[i]->m_data_buffer_->DistributionMap()[ibox]);
+                    }
+                }
+                BoxArray buff_ba(std::move(buff_bl));
+                DistributionMapping buff_dm(buff_pmap);
+
                 MultiFab tmp(buff_ba, buff_dm, ncomp, 0);
 
                 tmp.copy(*m_LabFrameDiags_[i]->m_data_buffer_, 0, 0, ncomp);
 
-#ifdef WARPX_USE_HDF5
-                for (int comp = 0; comp < ncomp; ++comp) {
-                    output_write_field(m_LabFrameDiags_[i]->m_file_name,
-                                       m_mesh_field_names[comp], tmp, comp,
-                                       lbound(buff_box).x, lbound(buff_box).y,
-                                       lbound(buff_box).z);
-                }
-#else
                 std::stringstream ss;
                 ss << m_LabFrameDiags_[i]->m_file_name << "/Level_0/"
                    << Concatenate("buffer", i_lab, 5);
@@ -769,9 +815,34 @@ void BackTransformedDiagnostic::Flush(const Geometry& /*geom*/)
     VisMF::SetHeaderVersion(current_version);
 }
 
-
-
-
+bool
+BackTransformedDiagnostic::
+GetActiveSlabRange(const Geometry& geom, const Real t_boost, int& k_lo, int& k_hi) const
+{
+    const Real zlo_boost = geom.ProbLo(m_boost_direction_);
+    const Real zhi_boost = geom.ProbHi(m_boost_direction_);
+    const Real dz_boost = geom.CellSize(m_boost_direction_);
+    const int k_domain_lo = geom.Domain().smallEnd(m_boost_direction_);
+
+    bool active = false;
+    for (const auto& diag : m_LabFrameDiags_) {
+        // Same as LabFrameDiag::updateCurrentZPositions, without updating the snapshot
+        const Real z_boost = (diag->m_t_lab*m_inv_gamma_boost_ - t_boost)*PhysConst::c*m_inv_beta_boost_;
+        const Real z_lab = (diag->m_t_lab - t_boost*m_inv_gamma_boost_)*PhysConst::c*m_inv_beta_boost_;
+
+        // Same selection as in writeLabFrameData
+        if ( ( z_boost < zlo_boost) or
+             ( z_boost > zhi_boost) or
+             ( z_lab < diag->m_diag_domain_lab_.lo(AMREX_SPACEDIM-1)) or
+             ( z_lab > diag->m_diag_domain_lab_.hi(AMREX_SPACEDIM-1)) ) continue;
+
+        const int k = k_domain_lo + static_cast<int>(std::floor((z_boost - zlo_boost)/dz_boost));
+        k_lo = active ? std::min(k_lo, k-1) : k-1;
+        k_hi = active ? std::max(k_hi, k+1) : k+1;
+        active = true;
+    }
+    return active;
+}
 
 void
 BackTransformedDiagnostic::
@@ -823,11 +894,10 @@ writeLabFrameData(const MultiFab* cell_centered_data,
                                              i_lab - m_num_buffer_ + 1);
                 m_LabFrameDiags_[i]->m_buff_box_.setBig(m_boost_direction_, i_lab);
 
-                BoxArray buff_ba(m_LabFrameDiags_[i]->m_buff_box_);
-                buff_ba.maxSize(m_max_box_size_);
-                DistributionMapping buff_dm(buff_ba);
-                m_LabFrameDiags_[i]->m_data_buffer_.reset( new MultiFab(buff_ba,
-                                                buff_dm, m_ncomp_to_dump, 0) );
+                m_LabFrameDiags_[i]->AllocateDataBuffer(m_boost_direction_,
+                                                        i_lab - m_num_buffer_ + 1,
+                                                        m_num_buffer_, m_max_box_size_,
+                                                        m_ncomp_to_dump);
             }
             // ... reset particle buffer particles_buffer_[i]
             if (WarpX::do_back_transformed_particles)
@@ -912,12 +982,13 @@ writeLabFrameData(const MultiFab* cell_centered_data,
 #ifdef WARPX_USE_HDF5
 
                 Box buff_box = m_LabFrameDiags_[i]->m_buff_box_;
-                for (int comp = 0; comp < m_LabFrameDiags_[i]->m_data_buffer_->nComp(); ++comp)
-                    output_write_field(m_LabFrameDiags_[i]->m_file_name,
-                                       m_mesh_field_names[comp],
-                                       *m_LabFrameDiags_[i]->m_data_buffer_, comp,
-                                       lbound(buff_box).x, lbound(buff_box).y,
-                                       lbound(buff_box).z);
+                const int ncomp = m_LabFrameDiags_[i]->m_data_buffer_->nComp();
+                const std::vector<std::string> field_paths(
+                    m_mesh_field_names.begin(), m_mesh_field_names.begin() + ncomp);
+                output_write_fields(m_LabFrameDiags_[i]->m_file_name, field_paths,
+                                    *m_LabFrameDiags_[i]->m_data_buffer_, buff_box,
+                                    lbound(buff_box).x, lbound(buff_box).y,
+                                    lbound(buff_box).z);
 #else
                 std::stringstream mesh_ss;
                 mesh_ss << m_LabFrameDiags_[i]->m_file_name << "/Level_0/" <<
@@ -1155,6 +1226,24 @@ updateCurrentZPositions(Real t_boost, Real inv_gamma, Real inv_beta)
     m_current_z_lab   = (m_t_lab - t_boost*inv_gamma)*PhysConst::c*inv_beta;
 }
 
+void
+LabFrameDiag::
+AllocateDataBuffer(int boost_direction, int lo, int num_buffer,
+                   int max_box_size, int ncomp)
+{
+    if (m_buff_ba_.empty()) {
+        Box buff_box = m_buff_box_;
+        buff_box.setSmall(boost_direction, 0);
+        buff_box.setBig(boost_direction, num_buffer - 1);
+        m_buff_ba_ = BoxArray(buff_box);
+        m_buff_ba_.maxSize(max_box_size);
+        m_buff_dm_ = DistributionMapping(m_buff_ba_);
+    }
+    BoxArray buff_ba = m_buff_ba_;
+    buff_ba.shift(boost_direction, lo);
+    m_data_buffer_.reset( new MultiFab(buff_ba, m_buff_dm_, ncomp, 0) );
+}
+
 void
 LabFrameDiag::
 createLabFrameDirectories() {
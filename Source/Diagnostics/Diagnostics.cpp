@@ -1,4 +1,5 @@
 #include "Diagnostics.H"
+#include "AsyncFlush.H"
 #include "ComputeDiagFunctors/CellCenterFunctor.H"
 #include "ComputeDiagFunctors/PartPerCellFunctor.H"
 #include "ComputeDiagFunctors/PartPerGridFunctor.H"
@@ -138,10 +139,10 @@ Diagnostics::InitBaseData ()
 
     // Construct Flush class.
     if        (m_format == "plotfile"){
-        m_flush_format = new FlushFormatPlotfile;
+        m_flush_format = new FlushFormatPlotfile(m_diag_name);
     } else if (m_format == "checkpoint"){
         // creating checkpoint format
-        m_flush_format = new FlushFormatCheckpoint;
+        m_flush_format = new FlushFormatCheckpoint(m_diag_name);
     } else if (m_format == "ascent"){
         m_flush_format = new FlushFormatAscent;
     } else if (m_format == "sensei"){
@@ -201,7 +202,12 @@ Diagnostics::FilterComputePackFlush (int step, bool force_flush)
 
         for (int i_buffer = 0; i_buffer < m_num_buffers; ++i_buffer) {
             if ( !DoDump (step, i_buffer, force_flush) ) continue;
-                Flush(i_buffer);
+            // With asynchronous output, the plotfile data is copied and written
+            // in the background: bound the number of snapshots in flight.
+            const bool async_flush = (m_format == "plotfile");
+            if (async_flush) AsyncFlush::BeginSnapshot();
+            Flush(i_buffer);
+            if (async_flush) AsyncFlush::EndSnapshot();
         }
 
     }
@@ -1,14 +1,124 @@
 #include "FlushFormatCheckpoint.H"
 #include "WarpX.H"
+#include "Diagnostics/AsyncFlush.H"
 #include "Utils/WarpXProfilerWrapper.H"
 
+#include <AMReX_Arena.H>
 #include <AMReX_buildInfo.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <set>
 
 using namespace amrex;
 
 namespace
 {
     const std::string level_prefix {"Level_"};
+    const std::string incremental_header_name {"WarpXIncrementalHeader"};
+
+    /** SplitMix64 finalizer: a bijective mixing of the 64 bits of x */
+    std::uint64_t Mix64 (std::uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    /** 128-bit hash of the data of a FAB, including its guard cells: the
+     *  byte-wise FNV-1a hash and an independent word-wise hash chained with
+     *  Mix64. An unchanged FAB is detected from the hash only, so the data
+     *  of a changed FAB would be lost if both hashes collided, which is
+     *  negligible for simulation data (but they are not cryptographic hashes).
+     *  On GPU, the data is hashed from a pinned host copy. */
+    std::array<std::uint64_t, 2> HashFab (const FArrayBox& fab)
+    {
+        const std::size_t nbytes = fab.nBytes();
+#ifdef AMREX_USE_GPU
+        void* host_data = The_Pinned_Arena()->alloc(nbytes);
+        Gpu::dtoh_memcpy(host_data, fab.dataPtr(), nbytes);
+        const auto* bytes = static_cast<const unsigned char*>(host_data);
+#else
+        const auto* bytes = reinterpret_cast<const unsigned char*>(fab.dataPtr());
+#endif
+        std::uint64_t fnv = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < nbytes; ++i) {
+            fnv ^= bytes[i];
+            fnv *= 1099511628211ULL;
+        }
+        std::uint64_t mix = Mix64(nbytes);
+        for (std::size_t i = 0; i < nbytes; i += sizeof(std::uint64_t)) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, bytes + i, std::min(sizeof(std::uint64_t), nbytes - i));
+            mix = Mix64(mix ^ word);
+        }
+#ifdef AMREX_USE_GPU
+        The_Pinned_Arena()->free(host_data);
+#endif
+        return {{fnv, mix}};
+    }
+
+    /** Content of the incremental header of a checkpoint */
+    struct IncrementalHeader
+    {
+        /** Directory of the full checkpoint this checkpoint refers to, empty if full */
+        std::string base_dir;
+        /** MultiFabs that are only in the full checkpoint */
+        std::set<std::string> refs;
+        /** Global indices of the FABs that changed since the full checkpoint */
+        std::map<std::string, std::vector<int>> deltas;
+    };
+
+    const IncrementalHeader& GetIncrementalHeader (const std::string& chkdir)
+    {
+        static std::map<std::string, IncrementalHeader> headers;
+        auto it = headers.find(chkdir);
+        if (it != headers.end()) return it->second;
+
+        IncrementalHeader& header = headers[chkdir];
+        const std::string file_name = chkdir + "/" + incremental_header_name;
+        if (!amrex::FileExists(file_name)) return header;
+
+        Vector<char> fileCharPtr;
+        ParallelDescriptor::ReadAndBcastFile(file_name, fileCharPtr);
+        std::istringstream is(std::string(fileCharPtr.dataPtr()));
+
+        std::string line;
+        while (std::getline(is, line)) {
+            std::istringstream lis(line);
+            std::string name, kind;
+            lis >> name >> kind;
+            if (name == "base") {
+                // The full checkpoint is in the same directory as this one
+                std::string parent = chkdir;
+                while (parent.size() > 1 && parent.back() == '/') parent.pop_back();
+                const auto slash = parent.find_last_of('/');
+                parent = (slash == std::string::npos) ? "" : parent.substr(0, slash+1);
+                header.base_dir = parent + kind;
+            } else if (kind == "ref") {
+                header.refs.insert(name);
+            } else if (kind == "delta") {
+                int n;
+                lis >> n;
+                std::vector<int>& indices = header.deltas[name];
+                indices.resize(n);
+                for (int i = 0; i < n; ++i) lis >> indices[i];
+            }
+        }
+        return header;
+    }
+}
+
+FlushFormatCheckpoint::FlushFormatCheckpoint (const std::string& diag_name)
+{
+    ParmParse pp(diag_name);
+    pp.query("checkpoint_incremental", m_incremental);
+    pp.query("checkpoint_full_period", m_full_period);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_full_period > 0,
+        diag_name + ".checkpoint_full_period must be positive");
 }
 
 void
@@ -26,6 +136,14 @@ FlushFormatCheckpoint::WriteToFile (
 
     auto & warpx = WarpX::GetInstance();
 
+    // Make sure that all the diagnostics written before this checkpoint,
+    // in the background or kept in memory by the reduced diagnostics,
+    // are on disk, so that a restart from it is consistent.
+    if (warpx.reduced_diags->m_plot_rd != 0) {
+        warpx.reduced_diags->FlushBuffers();
+    }
+    AsyncFlush::Drain();
+
     VisMF::Header::Version current_version = VisMF::GetHeaderVersion();
     VisMF::SetHeaderVersion(amrex::VisMF::Header::NoFabHeader_v1);
 
@@ -40,61 +158,90 @@ FlushFormatCheckpoint::WriteToFile (
 
     WriteJobInfo(checkpointname);
 
+    // Every m_full_period-th checkpoint is written in full and serves as the
+    // base of the following incremental checkpoints.
+    const bool full = !m_incremental || (m_num_written % m_full_period == 0);
+    ++m_num_written;
+    if (m_incremental) {
+        m_incremental_header.str("");
+        if (full) {
+            m_base_name = checkpointname;
+            m_base_records.clear();
+        } else {
+            amrex::Print() << "  (incremental, base " << m_base_name << ")\n";
+            const auto slash = m_base_name.find_last_of('/');
+            m_incremental_header << "base "
+                << ((slash == std::string::npos) ? m_base_name : m_base_name.substr(slash+1))
+                << "\n";
+        }
+    }
+
     for (int lev = 0; lev < nlev; ++lev)
     {
-        VisMF::Write(warpx.getEfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Ex_fp"));
-        VisMF::Write(warpx.getEfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Ey_fp"));
-        VisMF::Write(warpx.getEfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Ez_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Bx_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "By_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Bz_fp"));
+        auto const name = [lev] (const std::string& mf_name) {
+            return amrex::Concatenate(level_prefix, lev, 1) + "/" + mf_name;
+        };
+
+        WriteMultiFab(warpx.getEfield_fp(lev, 0), checkpointname, name("Ex_fp"), full);
+        WriteMultiFab(warpx.getEfield_fp(lev, 1), checkpointname, name("Ey_fp"), full);
+        WriteMultiFab(warpx.getEfield_fp(lev, 2), checkpointname, name("Ez_fp"), full);
+        WriteMultiFab(warpx.getBfield_fp(lev, 0), checkpointname, name("Bx_fp"), full);
+        WriteMultiFab(warpx.getBfield_fp(lev, 1), checkpointname, name("By_fp"), full);
+        WriteMultiFab(warpx.getBfield_fp(lev, 2), checkpointname, name("Bz_fp"), full);
         if (warpx.getis_synchronized()) {
             // Need to save j if synchronized because after restart we need j to evolve E by dt/2.
-            VisMF::Write(warpx.getcurrent_fp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "jx_fp"));
-            VisMF::Write(warpx.getcurrent_fp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "jy_fp"));
-            VisMF::Write(warpx.getcurrent_fp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "jz_fp"));
+            WriteMultiFab(warpx.getcurrent_fp(lev, 0), checkpointname, name("jx_fp"), full);
+            WriteMultiFab(warpx.getcurrent_fp(lev, 1), checkpointname, name("jy_fp"), full);
+            WriteMultiFab(warpx.getcurrent_fp(lev, 2), checkpointname, name("jz_fp"), full);
         }
 
         if (lev > 0)
         {
-            VisMF::Write(warpx.getEfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Ex_cp"));
-            VisMF::Write(warpx.getEfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Ey_cp"));
-            VisMF::Write(warpx.getEfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Ez_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Bx_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "By_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "Bz_cp"));
+            WriteMultiFab(warpx.getEfield_cp(lev, 0), checkpointname, name("Ex_cp"), full);
+            WriteMultiFab(warpx.getEfield_cp(lev, 1), checkpointname, name("Ey_cp"), full);
+            WriteMultiFab(warpx.getEfield_cp(lev, 2), checkpointname, name("Ez_cp"), full);
+            WriteMultiFab(warpx.getBfield_cp(lev, 0), checkpointname, name("Bx_cp"), full);
+            WriteMultiFab(warpx.getBfield_cp(lev, 1), checkpointname, name("By_cp"), full);
+            WriteMultiFab(warpx.getBfield_cp(lev, 2), checkpointname, name("Bz_cp"), full);
             if (warpx.getis_synchronized()) {
                 // Need to save j if synchronized because after restart we need j to evolve E by dt/2.
-                VisMF::Write(warpx.getcurrent_cp(lev, 0),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "jx_cp"));
-                VisMF::Write(warpx.getcurrent_cp(lev, 1),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "jy_cp"));
-                VisMF::Write(warpx.getcurrent_cp(lev, 2),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "jz_cp"));
+                WriteMultiFab(warpx.getcurrent_cp(lev, 0), checkpointname, name("jx_cp"), full);
+                WriteMultiFab(warpx.getcurrent_cp(lev, 1), checkpointname, name("jy_cp"), full);
+                WriteMultiFab(warpx.getcurrent_cp(lev, 2), checkpointname, name("jz_cp"), full);
             }
         }
 
         if (warpx.DoPML() && warpx.GetPML(lev)) {
-            warpx.GetPML(lev)->CheckPoint(
-                amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "pml"));
+            if (m_incremental) {
+                // Same file names as PML::CheckPoint
+                PML* pml = warpx.GetPML(lev);
+                const std::array<std::string,3> comps {"x", "y", "z"};
+                for (int i = 0; i < 3; ++i) {
+                    if (pml->GetE_fp()[0]) {
+                        WriteMultiFab(*pml->GetE_fp()[i], checkpointname, name("pml_E"+comps[i]+"_fp"), full);
+                        WriteMultiFab(*pml->GetB_fp()[i], checkpointname, name("pml_B"+comps[i]+"_fp"), full);
+                    }
+                    if (pml->GetE_cp()[0]) {
+                        WriteMultiFab(*pml->GetE_cp()[i], checkpointname, name("pml_E"+comps[i]+"_cp"), full);
+                        WriteMultiFab(*pml->GetB_cp()[i], checkpointname, name("pml_B"+comps[i]+"_cp"), full);
+                    }
+                }
+            } else {
+                warpx.GetPML(lev)->CheckPoint(
+                    amrex::MultiFabFileFullPrefix(lev, checkpointname, level_prefix, "pml"));
+            }
         }
     }
 
+    if (m_incremental && !full && ParallelDescriptor::IOProcessor()) {
+        std::ofstream HeaderFile(checkpointname + "/" + incremental_header_name,
+                                 std::ofstream::out | std::ofstream::trunc);
+        if( ! HeaderFile.good()) {
+            amrex::FileOpenFailed(checkpointname + "/" + incremental_header_name);
+        }
+        HeaderFile << m_incremental_header.str();
+    }
+
     CheckpointParticles(checkpointname, particle_diags);
 
     VisMF::SetHeaderVersion(current_version);
@@ -111,3 +258,109 @@ FlushFormatCheckpoint::CheckpointParticles(
             dir, particle_diags[i].getSpeciesName());
     }
 }
+
+void
+FlushFormatCheckpoint::WriteMultiFab (const MultiFab& mf, const std::string& chkdir,
+                                      const std::string& name, bool full) const
+{
+    const std::string path = chkdir + "/" + name;
+    if (!m_incremental) {
+        VisMF::Write(mf, path);
+        return;
+    }
+
+    Gpu::synchronize();
+    std::vector<FabHash> hashes(mf.local_size());
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        hashes[mfi.LocalIndex()] = HashFab(mf[mfi]);
+    }
+
+    auto base = m_base_records.find(name);
+    const bool same_layout = !full && base != m_base_records.end() &&
+                             base->second.ba == mf.boxArray() &&
+                             base->second.dm == mf.DistributionMap();
+    if (!same_layout) {
+        // Full checkpoint, or the grids changed since the last full checkpoint
+        VisMF::Write(mf, path);
+        if (full) {
+            m_base_records[name] = BaseRecord{mf.boxArray(), mf.DistributionMap(),
+                                              std::move(hashes)};
+        }
+        return;
+    }
+
+    // Find the FABs that changed since the last full checkpoint
+    Vector<int> changed(mf.size(), 0);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        if (hashes[mfi.LocalIndex()] != base->second.hashes[mfi.LocalIndex()]) {
+            changed[mfi.index()] = 1;
+        }
+    }
+    ParallelDescriptor::ReduceIntSum(changed.dataPtr(), changed.size());
+
+    BoxList bl;
+    Vector<int> pmap;
+    Vector<int> indices;
+    for (int i = 0; i < mf.size(); ++i) {
+        if (changed[i]) {
+            bl.push_back(mf.boxArray()[i]);
+            pmap.push_back(mf.DistributionMap()[i]);
+            indices.push_back(i);
+        }
+    }
+
+    if (indices.empty()) {
+        m_incremental_header << name << " ref\n";
+        return;
+    }
+
+    // The changed FABs stay on the ranks that own them
+    MultiFab delta(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)),
+                   mf.nComp(), mf.nGrowVect());
+    for (MFIter mfi(delta); mfi.isValid(); ++mfi) {
+        delta[mfi].copy<RunOn::Device>(mf[indices[mfi.index()]]);
+    }
+    Gpu::synchronize();
+    VisMF::Write(delta, path + "_delta");
+
+    m_incremental_header << name << " delta " << indices.size();
+    for (int i : indices) m_incremental_header << " " << i;
+    m_incremental_header << "\n";
+}
+
+bool
+FlushFormatCheckpoint::IsIncremental (const std::string& chkdir)
+{
+    return !GetIncrementalHeader(chkdir).base_dir.empty();
+}
+
+void
+FlushFormatCheckpoint::ReadMultiFab (MultiFab& mf, const std::string& chkdir,
+                                     const std::string& name)
+{
+    const IncrementalHeader& header = GetIncrementalHeader(chkdir);
+    auto delta = header.deltas.find(name);
+    if (header.refs.count(name) == 0 && delta == header.deltas.end()) {
+        VisMF::Read(mf, chkdir + "/" + name);
+        return;
+    }
+
+    VisMF::Read(mf, header.base_dir + "/" + name);
+
+    if (delta != header.deltas.end()) {
+        const std::vector<int>& indices = delta->second;
+        BoxList bl;
+        Vector<int> pmap;
+        for (int i : indices) {
+            bl.push_back(mf.boxArray()[i]);
+            pmap.push_back(mf.DistributionMap()[i]);
+        }
+        MultiFab delta_mf(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)),
+                          mf.nComp(), mf.nGrowVect());
+        VisMF::Read(delta_mf, chkdir + "/" + name + "_delta");
+        for (MFIter mfi(delta_mf); mfi.isValid(); ++mfi) {
+            mf[indices[mfi.index()]].copy<RunOn::Device>(delta_mf[mfi]);
+        }
+        Gpu::synchronize();
+    }
+}
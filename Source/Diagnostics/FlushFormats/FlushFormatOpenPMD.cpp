@@ -15,10 +15,44 @@ FlushFormatOpenPMD::FlushFormatOpenPMD (const std::string& diag_name)
     bool openpmd_tspf = true;
     pp.query("openpmd_backend", openpmd_backend);
     pp.query("openpmd_tspf", openpmd_tspf);
+
+    // Streaming (ADIOS2 SST engine): the data is staged in memory until the
+    // readers fetch it. QueueLimit is the number of steps that can be staged,
+    // QueueFullPolicy tells whether to wait for the readers ("Block") or to
+    // drop the new step, the staged ones being kept ("Discard"), when the
+    // queue is full. Both are passed as is to ADIOS2.
+    std::string openpmd_options {"{}"};
+    if (openpmd_backend == "sst") {
+        int queue_limit = 1;
+        std::string queue_full_policy {"Block"};
+        pp.query("openpmd_sst_queue_limit", queue_limit);
+        pp.query("openpmd_sst_queue_full_policy", queue_full_policy);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            queue_full_policy == "Block" || queue_full_policy == "Discard",
+            diag_name + ".openpmd_sst_queue_full_policy must be Block or Discard");
+        openpmd_options = R"({"adios2": {"engine": {"type": "sst", "parameters": {)"
+            R"("QueueLimit": ")" + std::to_string(queue_limit) + R"(", )"
+            R"("QueueFullPolicy": ")" + queue_full_policy + R"("}}}})";
+    }
+
     auto & warpx = WarpX::GetInstance();
     m_OpenPMDPlotWriter = new WarpXOpenPMDPlot(
-        openpmd_tspf, openpmd_backend, warpx.getPMLdirections()
+        openpmd_tspf, openpmd_backend, warpx.getPMLdirections(), openpmd_options
         );
+
+    // Data reduction: fields in single precision and compression by the backend
+    std::string precision {"double"};
+    std::string compression {""};
+    int compression_level = 1;
+    pp.query("output_precision", precision);
+    pp.query("openpmd_compression", compression);
+    pp.query("openpmd_compression_level", compression_level);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(precision == "double" || precision == "single",
+        diag_name + ".output_precision must be double or single");
+    m_OpenPMDPlotWriter->SetDataReduction(precision == "single", compression, compression_level);
+    // nothing is written to disk when streaming
+    m_report_output_size = (precision == "single" || !compression.empty())
+                           && openpmd_backend != "sst";
 }
 
 void
@@ -37,6 +71,13 @@ FlushFormatOpenPMD::WriteToFile (
         !plot_raw_fields && !plot_raw_fields_guards && !plot_raw_rho && !plot_raw_F,
         "Cannot plot raw data with OpenPMD output format. Use plotfile instead.");
 
+    const double start_time = amrex::second();
+    long raw_bytes = 0, size_before = 0;
+    if (m_report_output_size) {
+        raw_bytes = RawOutputBytes(mf, 1, particle_diags);
+        if (ParallelDescriptor::IOProcessor()) size_before = WarpXUtilIO::GetPathSize(prefix);
+    }
+
     // Set step and output directory name.
     m_OpenPMDPlotWriter->SetStep(iteration[0], prefix);
 
@@ -46,6 +87,11 @@ FlushFormatOpenPMD::WriteToFile (
 
     // particles: all (reside only on locally finest level)
     m_OpenPMDPlotWriter->WriteOpenPMDParticles(particle_diags);
+
+    // finalize the iteration (required for streaming)
+    m_OpenPMDPlotWriter->CloseStep();
+
+    if (m_report_output_size) ReportOutputSize(prefix, size_before, raw_bytes, start_time);
 }
 
 FlushFormatOpenPMD::~FlushFormatOpenPMD (){
@@ -1,5 +1,6 @@
 #include "FlushFormatPlotfile.H"
 #include "WarpX.H"
+#include "Diagnostics/AsyncFlush.H"
 #include "Utils/Interpolate.H"
 #include "Particles/Filter/FilterFunctors.H"
 
@@ -12,6 +13,19 @@ namespace
     const std::string level_prefix {"Level_"};
 }
 
+FlushFormatPlotfile::FlushFormatPlotfile (const std::string& diag_name)
+{
+    ParmParse pp(diag_name);
+    std::string precision {"double"};
+    pp.query("output_precision", precision);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(precision == "double" || precision == "single",
+        diag_name + ".output_precision must be double or single");
+    m_single_precision = (precision == "single");
+    // AMReX writes the plotfiles of the I/O thread in the native precision
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_single_precision || !AsyncFlush::Enabled(),
+        diag_name + ".output_precision = single is not supported with amrex.async_out = 1");
+}
+
 void
 FlushFormatPlotfile::WriteToFile (
     const amrex::Vector<std::string> varnames,
@@ -26,10 +40,18 @@ FlushFormatPlotfile::WriteToFile (
     const std::string& filename = amrex::Concatenate(prefix, iteration[0]);
     amrex::Print() << "  Writing plotfile " << filename << "\n";
 
+    const double start_time = amrex::second();
+    const long raw_bytes = m_single_precision ? RawOutputBytes(mf, nlev, particle_diags) : 0;
+
     Vector<std::string> rfs;
     VisMF::Header::Version current_version = VisMF::GetHeaderVersion();
     VisMF::SetHeaderVersion(amrex::VisMF::Header::Version_v1);
     if (plot_raw_fields) rfs.emplace_back("raw_fields");
+    // With header version v1, the FABs are converted to the FArrayBox format
+    // when written: use 32-bit floats for the fields if requested.
+    // Raw fields are always written in full precision.
+    const FABio::Format current_format = FArrayBox::getFormat();
+    if (m_single_precision) FArrayBox::setFormat(FABio::FAB_NATIVE_32);
     amrex::WriteMultiLevelPlotfile(filename, nlev,
                                    amrex::GetVecOfConstPtrs(mf),
                                    varnames, geom,
@@ -39,6 +61,7 @@ FlushFormatPlotfile::WriteToFile (
                                    "Cell",
                                    rfs
                                    );
+    FArrayBox::setFormat(current_format);
 
     WriteAllRawFields(plot_raw_fields, nlev, filename, plot_raw_fields_guards,
                       plot_raw_rho, plot_raw_F);
@@ -50,6 +73,8 @@ FlushFormatPlotfile::WriteToFile (
     WriteWarpXHeader(filename, particle_diags);
 
     VisMF::SetHeaderVersion(current_version);
+
+    if (m_single_precision) ReportOutputSize(filename, 0, raw_bytes, start_time);
 }
 
 void
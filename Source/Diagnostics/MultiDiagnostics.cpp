@@ -1,6 +1,9 @@
 #include "MultiDiagnostics.H"
+#include "AsyncFlush.H"
 #include <AMReX_ParmParse.H>
 
+#include <algorithm>
+
 using namespace amrex;
 
 MultiDiagnostics::MultiDiagnostics ()
@@ -47,6 +50,8 @@ MultiDiagnostics::ReadParameters ()
     ndiags = diags_names.size();
     Print()<<"ndiags "<<ndiags<<'\n';
 
+    AsyncFlush::ReadParameters();
+
     diags_types.resize( ndiags );
     for (int i=0; i<ndiags; i++){
         ParmParse ppd(diags_names[i]);
@@ -72,3 +77,10 @@ MultiDiagnostics::NewIteration ()
         diag->NewIteration();
     }
 }
+
+bool
+MultiDiagnostics::HasBackTransformed () const
+{
+    return std::find(diags_types.begin(), diags_types.end(), DiagTypes::BackTransformed)
+        != diags_types.end();
+}
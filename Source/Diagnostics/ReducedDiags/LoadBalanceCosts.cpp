@@ -9,6 +9,8 @@
 #include "LoadBalanceCosts.H"
 #include "Utils/WarpXUtil.H"
 
+#include <sstream>
+
 
 using namespace amrex;
 
@@ -16,7 +18,9 @@ using namespace amrex;
 LoadBalanceCosts::LoadBalanceCosts (std::string rd_name)
     : ReducedDiags{rd_name}
 {
-
+    // the host names are written as strings
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_binary,
+        "LoadBalanceCosts reduced diagnostics only supports the text format");
 }
 
 // function that gathers costs
@@ -96,6 +100,10 @@ void LoadBalanceCosts::ComputeDiags (int step)
                                       m_data.size(),
                                       ParallelDescriptor::IOProcessorNumber());
 
+    // the host names of the ranks do not change, gather them only once
+    if (m_hostnames_gathered) { return; }
+    m_hostnames_gathered = true;
+
 #ifdef AMREX_USE_MPI
     // now parallel reduce to IO proc and get string data (host name) over all procs
     // MPI Gatherv preliminaries
@@ -178,12 +186,10 @@ void LoadBalanceCosts::ComputeDiags (int step)
 }
 
 // write to file function for cost
-void LoadBalanceCosts::WriteToFile (int step) const
+void LoadBalanceCosts::WriteToFile (int step)
 {
-    // open file
-    std::ofstream ofs;
-    ofs.open(m_path + m_rd_name + "." + m_extension,
-            std::ofstream::out | std::ofstream::app);
+    // format the row; it is written to file with the buffered rows
+    std::ostringstream ofs;
 
     // write step
     ofs << step+1 << m_sep;
@@ -210,19 +216,24 @@ void LoadBalanceCosts::WriteToFile (int step) const
     // end loop over data size
 
     // end line
-    ofs << std::endl;
+    ofs << "\n";
 
-    // close file
-    ofs.close();
+    m_text_buffer += ofs.str();
+    ++m_buffered_rows;
 
 
     // get WarpX class object
     auto& warpx = WarpX::GetInstance();
 
+    // final step is a special case, fill jagged array with NaN
+    const bool final_step = (step == (warpx.maxStep() - (warpx.maxStep()%m_freq) - 1 ));
+
+    // write the buffer when it is full, or before the file is completed
+    if (m_buffered_rows >= m_buffer_size || final_step) { FlushBuffer(); }
+
     if (!ParallelDescriptor::IOProcessor()) return;
 
-    // final step is a special case, fill jagged array with NaN
-    if (step == (warpx.maxStep() - (warpx.maxStep()%m_freq) - 1 ))
+    if (final_step)
     {
         // open tmp file to copy data
         std::string fileTmpName = m_path + m_rd_name + ".tmp." + m_extension;
@@ -7,6 +7,7 @@
 
 #include "LoadBalanceCosts.H"
 #include "ParticleHistogram.H"
+#include "PhaseSpaceHistogram.H"
 #include "BeamRelevant.H"
 #include "ParticleEnergy.H"
 #include "FieldEnergy.H"
@@ -67,6 +68,11 @@ MultiReducedDiags::MultiReducedDiags ()
             m_multi_rd[i_rd].reset
                 ( new ParticleHistogram(m_rd_names[i_rd]));
         }
+        else if (rd_type.compare("PhaseSpaceHistogram") == 0)
+        {
+            m_multi_rd[i_rd].reset
+                ( new PhaseSpaceHistogram(m_rd_names[i_rd]));
+        }
         else
         { Abort("No matching reduced diagnostics type found."); }
         // end if match diags
@@ -110,3 +116,30 @@ void MultiReducedDiags::WriteToFile (int step)
     // end loop over all reduced diags
 }
 // end void MultiReducedDiags::WriteToFile
+
+// function to write the buffered data
+void MultiReducedDiags::FlushBuffers ()
+{
+
+    // Only the I/O rank does
+    if ( !ParallelDescriptor::IOProcessor() ) { return; }
+
+    // loop over all reduced diags
+    for (int i_rd = 0; i_rd < m_rd_names.size(); ++i_rd)
+    {
+        m_multi_rd[i_rd]->FlushBuffer();
+    }
+    // end loop over all reduced diags
+}
+// end void MultiReducedDiags::FlushBuffers
+
+// function to check whether rows are kept in memory
+bool MultiReducedDiags::HasBuffers () const
+{
+    for (const auto& rd : m_multi_rd)
+    {
+        if (rd->m_buffer_size > 1) { return true; }
+    }
+    return false;
+}
+// end bool MultiReducedDiags::HasBuffers
@@ -0,0 +1,252 @@
+/* Copyright 2020 The WarpX Community
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "PhaseSpaceHistogram.H"
+#include "WarpX.H"
+#include "Utils/WarpXUtil.H"
+#include "Utils/WarpXConst.H"
+#include "Particles/Pusher/GetAndSetPosition.H"
+
+#include <AMReX_REAL.H>
+
+#include <cmath>
+#include <sstream>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
+
+using namespace amrex;
+
+// constructor
+PhaseSpaceHistogram::PhaseSpaceHistogram (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+
+    ParmParse pp(rd_name);
+
+    // read species
+    std::string selected_species_name;
+    pp.get("species",selected_species_name);
+
+    // read number of axes
+    pp.get("dimensions", m_dims);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_dims >= 1 && m_dims <= m_max_dims,
+        rd_name + ".dimensions must be 1, 2 or 3");
+
+    // read the function and the bins of each axis
+    for (int d = 0; d < m_dims; ++d)
+    {
+        const std::string axis = "axis" + std::to_string(d+1);
+        pp.get((axis + "_bin_number").c_str(), m_bin_num[d]);
+        pp.get((axis + "_bin_min").c_str(),    m_bin_min[d]);
+        pp.get((axis + "_bin_max").c_str(),    m_bin_max[d]);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_bin_num[d] > 0 && m_bin_max[d] > m_bin_min[d],
+            rd_name + "." + axis + ": need bin_number > 0 and bin_max > bin_min");
+
+        std::string function_string = "";
+        Store_parserString(pp, axis + "_function(t,x,y,z,ux,uy,uz)",
+                           function_string);
+        m_axis_parsers[d].reset(new ParserWrapper<m_nvars>(
+            makeParser(function_string,{"t","x","y","z","ux","uy","uz"})));
+    }
+
+    // read the deposited value; it is multiplied by the particle weight
+    std::string value_string = "1";
+    if (pp.contains("value_function(t,x,y,z,ux,uy,uz)")) {
+        Store_parserString(pp, "value_function(t,x,y,z,ux,uy,uz)", value_string);
+    }
+    m_value_parser.reset(new ParserWrapper<m_nvars>(
+        makeParser(value_string,{"t","x","y","z","ux","uy","uz"})));
+
+    // get MultiParticleContainer class object
+    auto & mypc = WarpX::GetInstance().GetPartContainer();
+    // get species names (std::vector<std::string>)
+    auto const species_names = mypc.GetSpeciesNames();
+    // select species
+    for ( int i = 0; i < mypc.nSpecies(); ++i )
+    {
+        if ( selected_species_name == species_names[i] ){
+            m_selected_species_id = i;
+        }
+    }
+    // if m_selected_species_id is not modified
+    if ( m_selected_species_id == -1 ){
+        Abort("Unknown species for PhaseSpaceHistogram reduced diagnostic.");
+    }
+
+    // resize data array
+    int nbins = 1;
+    for (int d = 0; d < m_dims; ++d) nbins *= m_bin_num[d];
+    m_data.resize(nbins,0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs;
+            ofs.open(m_path + m_rd_name + "." + m_extension,
+                std::ofstream::out | std::ofstream::app);
+            // write header row; the last axis varies fastest
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            for (int i = 0; i < nbins; ++i)
+            {
+                std::array<int, m_max_dims> ibin {{0, 0, 0}};
+                int rest = i;
+                for (int d = m_dims-1; d >= 0; --d) {
+                    ibin[d] = rest % m_bin_num[d];
+                    rest /= m_bin_num[d];
+                }
+                std::stringstream name;
+                name << "bin";
+                for (int d = 0; d < m_dims; ++d) name << "_" << ibin[d]+1;
+                name << "=";
+                for (int d = 0; d < m_dims; ++d) {
+                    const Real bin_size = (m_bin_max[d] - m_bin_min[d]) / m_bin_num[d];
+                    if (d > 0) name << ",";
+                    name << std::to_string(m_bin_min[d] + bin_size*(Real(ibin[d])+0.5_rt));
+                }
+                ofs << m_sep;
+                ofs << "[" + std::to_string(3+i) + "]";
+                ofs << name.str() << "()";
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+
+}
+// end constructor
+
+// function that deposits the particles onto the grid
+void PhaseSpaceHistogram::ComputeDiags (int step)
+{
+
+    // Judge if the diags should be done
+    if ( (step+1) % m_freq != 0 ) return;
+
+    // get WarpX class object
+    auto & warpx = WarpX::GetInstance();
+
+    // get time at level 0
+    auto const t = warpx.gett_new(0);
+
+    // get MultiParticleContainer class object
+    auto & mypc = warpx.GetPartContainer();
+
+    // get WarpXParticleContainer class object
+    auto & myspc = mypc.GetParticleContainer(m_selected_species_id);
+
+    // get parsers
+    const int dims = m_dims;
+    ParserWrapper<m_nvars> *axis0_parser = m_axis_parsers[0].get();
+    ParserWrapper<m_nvars> *axis1_parser = m_axis_parsers[1].get();
+    ParserWrapper<m_nvars> *axis2_parser = m_axis_parsers[2].get();
+    ParserWrapper<m_nvars> *value_parser = m_value_parser.get();
+
+    // declare local variables
+    const int n0 = m_bin_num[0];
+    const int n1 = m_bin_num[1];
+    const int n2 = m_bin_num[2];
+    const Real min0 = m_bin_min[0];
+    const Real min1 = m_bin_min[1];
+    const Real min2 = m_bin_min[2];
+    const Real inv_size0 = n0 / (m_bin_max[0] - m_bin_min[0]);
+    const Real inv_size1 = n1 / (m_bin_max[1] - m_bin_min[1]);
+    const Real inv_size2 = n2 / (m_bin_max[2] - m_bin_min[2]);
+    const int nbins = m_data.size();
+
+    // one private grid per thread, so that the threads do not need atomics
+#if (defined _OPENMP) && !(defined AMREX_USE_GPU)
+    const int nthreads = omp_get_max_threads();
+#else
+    const int nthreads = 1;
+#endif
+    Gpu::ManagedDeviceVector<Real> grids(nthreads*nbins, 0.0_rt);
+    Real* const grids_ptr = grids.dataPtr();
+
+    for (int lev = 0; lev <= myspc.finestLevel(); ++lev)
+    {
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        {
+#if (defined _OPENMP) && !(defined AMREX_USE_GPU)
+            Real* const grid = grids_ptr + nbins*omp_get_thread_num();
+#else
+            Real* const grid = grids_ptr;
+#endif
+
+            for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti)
+            {
+                auto const GetPosition = GetParticlePosition(pti);
+                auto& attribs = pti.GetAttribs();
+                const ParticleReal* AMREX_RESTRICT wp = attribs[PIdx::w].dataPtr();
+                const ParticleReal* AMREX_RESTRICT uxp = attribs[PIdx::ux].dataPtr();
+                const ParticleReal* AMREX_RESTRICT uyp = attribs[PIdx::uy].dataPtr();
+                const ParticleReal* AMREX_RESTRICT uzp = attribs[PIdx::uz].dataPtr();
+
+                amrex::ParallelFor(pti.numParticles(),
+                [=] AMREX_GPU_DEVICE (long ip)
+                {
+                    ParticleReal x, y, z;
+                    GetPosition(ip, x, y, z);
+                    auto const ux = uxp[ip]/PhysConst::c;
+                    auto const uy = uyp[ip]/PhysConst::c;
+                    auto const uz = uzp[ip]/PhysConst::c;
+
+                    // bin index along each axis; particles outside of the grid are skipped
+                    auto const i0 = static_cast<int>(std::floor(
+                        ((*axis0_parser)(t,x,y,z,ux,uy,uz) - min0)*inv_size0));
+                    if (i0 < 0 || i0 >= n0) return;
+                    int i1 = 0;
+                    if (dims > 1) {
+                        i1 = static_cast<int>(std::floor(
+                            ((*axis1_parser)(t,x,y,z,ux,uy,uz) - min1)*inv_size1));
+                        if (i1 < 0 || i1 >= n1) return;
+                    }
+                    int i2 = 0;
+                    if (dims > 2) {
+                        i2 = static_cast<int>(std::floor(
+                            ((*axis2_parser)(t,x,y,z,ux,uy,uz) - min2)*inv_size2));
+                        if (i2 < 0 || i2 >= n2) return;
+                    }
+
+                    // the last axis varies fastest
+                    int ibin = i0;
+                    if (dims > 1) ibin = ibin*n1 + i1;
+                    if (dims > 2) ibin = ibin*n2 + i2;
+
+                    amrex::Gpu::Atomic::Add(&grid[ibin],
+                        wp[ip]*(*value_parser)(t,x,y,z,ux,uy,uz));
+                });
+            }
+        }
+    }
+
+    // sum the thread grids
+    Gpu::synchronize();
+    for (int i = 0; i < nbins; ++i)
+    {
+        Real sum = 0.0_rt;
+        for (int ithread = 0; ithread < nthreads; ++ithread) {
+            sum += grids_ptr[ithread*nbins + i];
+        }
+        m_data[i] = sum;
+    }
+
+    // reduced sum over mpi ranks
+    ParallelDescriptor::ReduceRealSum
+        (m_data.data(), m_data.size(), ParallelDescriptor::IOProcessorNumber());
+
+}
+// end void PhaseSpaceHistogram::ComputeDiags
@@ -9,7 +9,9 @@
 #include "WarpX.H"
 #include "AMReX_ParmParse.H"
 #include "AMReX_Utility.H"
+#include <cstdint>
 #include <iomanip>
+#include <sstream>
 
 using namespace amrex;
 
@@ -24,9 +26,22 @@ ReducedDiags::ReducedDiags (std::string rd_name)
     // read path
     pp.query("path", m_path);
 
+    // read output format
+    std::string format = "text";
+    pp.query("format", format);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(format == "text" || format == "binary",
+        m_rd_name + ".format must be text or binary");
+    m_binary = (format == "binary");
+    if (m_binary) { m_extension = "bin"; }
+
     // read extension
     pp.query("extension", m_extension);
 
+    // read number of rows buffered in memory
+    pp.query("buffer_size", m_buffer_size);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_buffer_size > 0,
+        m_rd_name + ".buffer_size must be positive");
+
     // creater folder
     if (!UtilCreateDirectory(m_path, 0755))
     { CreateDirectoryFailed(m_path); }
@@ -55,38 +70,104 @@ ReducedDiags::ReducedDiags (std::string rd_name)
 // end constructor
 
 // write to file function
-void ReducedDiags::WriteToFile (int step) const
+void ReducedDiags::WriteToFile (int step)
 {
 
-    // open file
-    std::ofstream ofs;
-    ofs.open(m_path + m_rd_name + "." + m_extension,
-        std::ofstream::out | std::ofstream::app);
+    if (m_binary)
+    {
+        // step, time and data, all stored as double
+        m_binary_ncols = 2 + m_data.size();
+        m_binary_buffer.push_back(step+1);
+        m_binary_buffer.push_back(WarpX::GetInstance().gett_new(0));
+        m_binary_buffer.insert(m_binary_buffer.end(), m_data.begin(), m_data.end());
+    }
+    else
+    {
+        std::ostringstream ofs;
+
+        // write step
+        ofs << step+1;
+
+        ofs << m_sep;
+
+        // set precision
+        ofs << std::fixed << std::setprecision(14) << std::scientific;
+
+        // write time
+        ofs << WarpX::GetInstance().gett_new(0);
+
+        // loop over data size and write
+        for (int i = 0; i < m_data.size(); ++i)
+        {
+            ofs << m_sep;
+            ofs << m_data[i];
+        }
+        // end loop over data size
+
+        // end line
+        ofs << "\n";
+
+        m_text_buffer += ofs.str();
+    }
 
-    // write step
-    ofs << step+1;
+    // write the buffer when it is full
+    ++m_buffered_rows;
+    if (m_buffered_rows >= m_buffer_size) { FlushBuffer(); }
 
-    ofs << m_sep;
+}
+// end ReducedDiags::WriteToFile
 
-    // set precision
-    ofs << std::fixed << std::setprecision(14) << std::scientific;
+// write the buffered rows to file
+void ReducedDiags::FlushBuffer ()
+{
 
-    // write time
-    ofs << WarpX::GetInstance().gett_new(0);
+    if (m_buffered_rows == 0) { return; }
 
-    // loop over data size and write
-    for (int i = 0; i < m_data.size(); ++i)
+    if (m_binary)
     {
-        ofs << m_sep;
-        ofs << m_data[i];
+        // open file
+        std::ofstream ofs;
+        ofs.open(m_path + m_rd_name + "." + m_extension,
+            std::ofstream::out | std::ofstream::app | std::ofstream::binary);
+
+        // one block per flush: number of rows and columns, then the
+        // buffered rows stored column by column
+        const std::int32_t nrows = m_buffered_rows;
+        const std::int32_t ncols = m_binary_ncols;
+        ofs.write(reinterpret_cast<const char*>(&nrows), sizeof(nrows));
+        ofs.write(reinterpret_cast<const char*>(&ncols), sizeof(ncols));
+        std::vector<double> column(nrows);
+        for (int icol = 0; icol < ncols; ++icol)
+        {
+            for (int irow = 0; irow < nrows; ++irow)
+            {
+                column[irow] = m_binary_buffer[irow*ncols + icol];
+            }
+            ofs.write(reinterpret_cast<const char*>(column.data()),
+                      nrows*sizeof(double));
+        }
+
+        // close file
+        ofs.close();
+
+        m_binary_buffer.clear();
     }
-    // end loop over data size
+    else
+    {
+        // open file
+        std::ofstream ofs;
+        ofs.open(m_path + m_rd_name + "." + m_extension,
+            std::ofstream::out | std::ofstream::app);
 
-    // end line
-    ofs << std::endl;
+        ofs << m_text_buffer;
 
-    // close file
-    ofs.close();
+        // close file
+        ofs.close();
+
+        m_text_buffer.clear();
+    }
+
+    m_buffered_rows = 0;
 
 }
-// end ReducedDiags::WriteToFile
+// end ReducedDiags::FlushBuffer
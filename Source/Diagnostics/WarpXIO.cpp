@@ -11,6 +11,7 @@
 #include "FieldIO.H"
 #include "SliceDiagnostic.H"
 #include "Utils/CoarsenIO.H"
+#include "FlushFormats/FlushFormatCheckpoint.H"
 
 #ifdef WARPX_USE_OPENPMD
 #   include "Diagnostics/WarpXOpenPMD.H"
@@ -20,6 +21,8 @@
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_buildInfo.H>
 
+#include <array>
+
 #ifdef BL_USE_SENSEI_INSITU
 #   include <AMReX_AmrMeshInSituBridge.H>
 #endif
@@ -39,6 +42,28 @@ WarpX::GotoNextLine (std::istream& is)
     is.ignore(bl_ignore_max, '\n');
 }
 
+BoxArray
+WarpX::MakeRestartFineGrids (int lev, const BoxArray& ba) const
+{
+    // Work on blocks of the blocking factor, as AmrMesh::MakeNewGrids does
+    // with the tagged cells, so that chopping never splits a block.
+    const IntVect& bf = blockingFactor(lev);
+    BoxList bl = ba.boxList();
+    bl.simplify();
+    BoxArray new_ba(std::move(bl));
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(new_ba.coarsenable(bf),
+        "amr.restart_new_decomposition: the refined patches of the checkpoint"
+        " must be aligned on the current amr.blocking_factor");
+    new_ba.coarsen(bf);
+    new_ba.maxSize(maxGridSize(lev)/bf);
+    new_ba.refine(bf);
+    // Same refinement of the layout as for the base grids (AmrMesh::MakeBaseGrids)
+    if (refine_grid_layout) {
+        ChopGrids(lev, new_ba, ParallelDescriptor::NProcs());
+    }
+    return new_ba;
+}
+
 void
 WarpX::InitFromCheckpoint ()
 {
@@ -143,6 +168,15 @@ WarpX::InitFromCheckpoint ()
             BoxArray ba;
             ba.readFrom(is);
             GotoNextLine(is);
+            if (restart_new_decomposition) {
+                // Decompose the domain with the current inputs; the refined
+                // patches are kept and only re-chopped.
+                if (lev == 0) {
+                    ba = MakeBaseGrids();
+                } else {
+                    ba = MakeRestartFineGrids(lev, ba);
+                }
+            }
             DistributionMapping dm { ba, ParallelDescriptor::NProcs() };
             SetBoxArray(lev, ba);
             SetDistributionMap(lev, dm);
@@ -154,9 +188,30 @@ WarpX::InitFromCheckpoint ()
 
     const int nlevs = finestLevel()+1;
 
+    // Read a field from the checkpoint. With a new decomposition, the field is
+    // read with the layout of the checkpoint and then copied to the new grids.
+    auto const read_field = [this] (MultiFab& mf, const std::string& name) {
+        if (!restart_new_decomposition) {
+            FlushFormatCheckpoint::ReadMultiFab(mf, restart_chkfile, name);
+            return;
+        }
+        MultiFab chk_mf;
+        FlushFormatCheckpoint::ReadMultiFab(chk_mf, restart_chkfile, name);
+        const IntVect ng = mf.nGrowVect();
+        // The guard cells first (for those outside of all the checkpoint
+        // grids), then the valid cells, which take precedence.
+        mf.ParallelCopy(chk_mf, 0, 0, mf.nComp(), amrex::min(chk_mf.nGrowVect(), ng), ng);
+        mf.ParallelCopy(chk_mf, 0, 0, mf.nComp(), IntVect(0), ng);
+    };
+
     // Initialize the field data
     for (int lev = 0; lev < nlevs; ++lev)
     {
+        // Path of a MultiFab of this level, relative to the checkpoint directory
+        auto const level_name = [lev] (const std::string& mf_name) {
+            return amrex::Concatenate(level_prefix, lev, 1) + "/" + mf_name;
+        };
+
         for (int i = 0; i < 3; ++i) {
             current_fp[lev][i]->setVal(0.0);
             Efield_fp[lev][i]->setVal(0.0);
@@ -174,52 +229,34 @@ WarpX::InitFromCheckpoint ()
             }
         }
 
-        VisMF::Read(*Efield_fp[lev][0],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Ex_fp"));
-        VisMF::Read(*Efield_fp[lev][1],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Ey_fp"));
-        VisMF::Read(*Efield_fp[lev][2],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Ez_fp"));
+        read_field(*Efield_fp[lev][0], level_name("Ex_fp"));
+        read_field(*Efield_fp[lev][1], level_name("Ey_fp"));
+        read_field(*Efield_fp[lev][2], level_name("Ez_fp"));
 
-        VisMF::Read(*Bfield_fp[lev][0],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Bx_fp"));
-        VisMF::Read(*Bfield_fp[lev][1],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "By_fp"));
-        VisMF::Read(*Bfield_fp[lev][2],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Bz_fp"));
+        read_field(*Bfield_fp[lev][0], level_name("Bx_fp"));
+        read_field(*Bfield_fp[lev][1], level_name("By_fp"));
+        read_field(*Bfield_fp[lev][2], level_name("Bz_fp"));
 
         if (is_synchronized) {
-            VisMF::Read(*current_fp[lev][0],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "jx_fp"));
-            VisMF::Read(*current_fp[lev][1],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "jy_fp"));
-            VisMF::Read(*current_fp[lev][2],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "jz_fp"));
+            read_field(*current_fp[lev][0], level_name("jx_fp"));
+            read_field(*current_fp[lev][1], level_name("jy_fp"));
+            read_field(*current_fp[lev][2], level_name("jz_fp"));
         }
 
         if (lev > 0)
         {
-            VisMF::Read(*Efield_cp[lev][0],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Ex_cp"));
-            VisMF::Read(*Efield_cp[lev][1],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Ey_cp"));
-            VisMF::Read(*Efield_cp[lev][2],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Ez_cp"));
-
-            VisMF::Read(*Bfield_cp[lev][0],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Bx_cp"));
-            VisMF::Read(*Bfield_cp[lev][1],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "By_cp"));
-            VisMF::Read(*Bfield_cp[lev][2],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Bz_cp"));
+            read_field(*Efield_cp[lev][0], level_name("Ex_cp"));
+            read_field(*Efield_cp[lev][1], level_name("Ey_cp"));
+            read_field(*Efield_cp[lev][2], level_name("Ez_cp"));
+
+            read_field(*Bfield_cp[lev][0], level_name("Bx_cp"));
+            read_field(*Bfield_cp[lev][1], level_name("By_cp"));
+            read_field(*Bfield_cp[lev][2], level_name("Bz_cp"));
 
             if (is_synchronized) {
-                VisMF::Read(*current_cp[lev][0],
-                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "jx_cp"));
-                VisMF::Read(*current_cp[lev][1],
-                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "jy_cp"));
-                VisMF::Read(*current_cp[lev][2],
-                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "jz_cp"));
+                read_field(*current_cp[lev][0], level_name("jx_cp"));
+                read_field(*current_cp[lev][1], level_name("jy_cp"));
+                read_field(*current_cp[lev][2], level_name("jz_cp"));
             }
         }
     }
@@ -228,13 +265,34 @@ WarpX::InitFromCheckpoint ()
     {
         InitPML();
         for (int lev = 0; lev < nlevs; ++lev) {
-            pml[lev]->Restart(amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "pml"));
+            if (restart_new_decomposition ||
+                FlushFormatCheckpoint::IsIncremental(restart_chkfile)) {
+                // Same file names as PML::Restart
+                const std::string pml_name = amrex::Concatenate(level_prefix, lev, 1) + "/pml";
+                const std::array<std::string,3> comps {"x", "y", "z"};
+                for (int i = 0; i < 3; ++i) {
+                    if (pml[lev]->GetE_fp()[0]) {
+                        read_field(*pml[lev]->GetE_fp()[i], pml_name + "_E" + comps[i] + "_fp");
+                        read_field(*pml[lev]->GetB_fp()[i], pml_name + "_B" + comps[i] + "_fp");
+                    }
+                    if (pml[lev]->GetE_cp()[0]) {
+                        read_field(*pml[lev]->GetE_cp()[i], pml_name + "_E" + comps[i] + "_cp");
+                        read_field(*pml[lev]->GetB_cp()[i], pml_name + "_B" + comps[i] + "_cp");
+                    }
+                }
+            } else {
+                pml[lev]->Restart(amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "pml"));
+            }
         }
     }
 
     // Initilize particles
     mypc->AllocData();
     mypc->Restart(restart_chkfile);
+    if (restart_new_decomposition) {
+        // Make sure that the particles are on the ranks owning the new grids
+        mypc->Redistribute();
+    }
 
 }
 
@@ -277,3 +335,77 @@ WarpX::GetCellCenteredData() {
 
     return std::move(cc[0]);
 }
+
+std::unique_ptr<MultiFab>
+WarpX::GetCellCenteredSlabData (int dir, int k_lo, int k_hi)
+{
+    WARPX_PROFILE("WarpX::GetCellCenteredSlabData");
+
+    const int ng =  1;
+    const int nc = 10;
+
+    // Cells of the slab
+    Box slab = geom[0].Domain();
+    slab.setSmall(dir, std::max(k_lo, slab.smallEnd(dir)));
+    slab.setBig(dir, std::min(k_hi, slab.bigEnd(dir)));
+
+    // Intersect the grids with the slab. Each piece stays on the rank that
+    // owns the grid, so that the fields are read locally.
+    BoxList bl;
+    Vector<int> pmap;
+    Vector<int> src_index;
+    for (int i = 0; i < grids[0].size(); ++i) {
+        const Box b = grids[0][i] & slab;
+        if (b.ok()) {
+            bl.push_back(b);
+            pmap.push_back(dmap[0][i]);
+            src_index.push_back(i);
+        }
+    }
+    auto cc = std::make_unique<MultiFab>(BoxArray(std::move(bl)),
+                                         DistributionMapping(std::move(pmap)), nc, ng);
+
+    // Same components as GetCellCenteredData: E, B, j, rho. The charge
+    // density is only deposited on the nodes of the slab.
+    const std::unique_ptr<MultiFab>& charge_density = mypc->GetChargeDensity(0, slab);
+    const std::array<const MultiFab*, 10> src = {
+        Efield_aux[0][0].get(), Efield_aux[0][1].get(), Efield_aux[0][2].get(),
+        Bfield_aux[0][0].get(), Bfield_aux[0][1].get(), Bfield_aux[0][2].get(),
+        current_fp[0][0].get(), current_fp[0][1].get(), current_fp[0][2].get(),
+        charge_density.get() };
+
+    // Staggering of each source (always 3D), destination is cell-centered
+    Gpu::ManagedVector<int> sf_gpuarr(3*nc, 0), sc_gpuarr(3, 0), cr_gpuarr(3, 1);
+    for (int icomp = 0; icomp < nc; ++icomp) {
+        const IntVect stag = src[icomp]->ixType().toIntVect();
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            sf_gpuarr[3*icomp+idim] = stag[idim];
+        }
+    }
+    int const* const AMREX_RESTRICT sc = sc_gpuarr.data();
+    int const* const AMREX_RESTRICT cr = cr_gpuarr.data();
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*cc, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        const int isrc = src_index[mfi.index()];
+        Array4<Real> const& arr_dst = cc->array(mfi);
+        for (int icomp = 0; icomp < nc; ++icomp) {
+            Array4<Real const> const& arr_src = (*src[icomp])[isrc].const_array();
+            int const* const AMREX_RESTRICT sf = sf_gpuarr.data() + 3*icomp;
+            ParallelFor( bx,
+                         [=] AMREX_GPU_DEVICE( int i, int j, int k )
+                         {
+                             arr_dst(i,j,k,icomp) = CoarsenIO::Interp(
+                                 arr_src, sf, sc, cr, i, j, k, 0 );
+                         } );
+        }
+    }
+
+    cc->FillBoundary(geom[0].periodicity());
+
+    return cc;
+}
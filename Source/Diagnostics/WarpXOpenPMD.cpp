@@ -140,10 +140,12 @@ namespace detail
 
 #ifdef WARPX_USE_OPENPMD
 WarpXOpenPMDPlot::WarpXOpenPMDPlot(bool oneFilePerTS,
-    std::string openPMDFileType, std::vector<bool> fieldPMLdirections)
+    std::string openPMDFileType, std::vector<bool> fieldPMLdirections,
+    std::string options)
   :m_Series(nullptr),
    m_OneFilePerTS(oneFilePerTS),
    m_OpenPMDFileType(std::move(openPMDFileType)),
+   m_OpenPMDOptions(std::move(options)),
    m_fieldPMLdirections(std::move(fieldPMLdirections))
 {
   // pick first available backend if default is chosen
@@ -157,6 +159,16 @@ WarpXOpenPMDPlot::WarpXOpenPMDPlot(bool oneFilePerTS,
 #else
     m_OpenPMDFileType = "json";
 #endif
+
+  // streaming: one long-lived series, to which the iterations are appended
+  if( m_OpenPMDFileType == "sst" ) {
+#if openPMD_HAVE_ADIOS2==1 && \
+    (OPENPMDAPI_VERSION_MAJOR > 0 || OPENPMDAPI_VERSION_MINOR >= 12)
+    m_OneFilePerTS = false;
+#else
+    amrex::Abort("openPMD streaming (sst) requires openPMD-api >= 0.12 with ADIOS2 support");
+#endif
+  }
 }
 
 WarpXOpenPMDPlot::~WarpXOpenPMDPlot()
@@ -197,8 +209,49 @@ void WarpXOpenPMDPlot::SetStep(int ts, const std::string& filePrefix)
   }
 
     m_CurrentStep =  ts;
-    Init(openPMD::AccessType::CREATE, filePrefix);
+    // with one file for all steps, keep the series open and append the iteration
+    if (m_OneFilePerTS || !m_Series)
+        Init(openPMD::AccessType::CREATE, filePrefix);
+
+}
+
+void WarpXOpenPMDPlot::SetDataReduction(bool singlePrecisionFields,
+                                        std::string compression, int compressionLevel)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(compressionLevel >= 0 && compressionLevel <= 255,
+        "openPMD compression level must be in [0, 255]");
+    m_SinglePrecisionFields = singlePrecisionFields;
+    m_Compression = std::move(compression);
+    m_CompressionLevel = compressionLevel;
+}
+
+void WarpXOpenPMDPlot::SetCompression(openPMD::Dataset& dataset) const
+{
+    if (!m_Compression.empty())
+        dataset.setCompression(m_Compression, static_cast<uint8_t>(m_CompressionLevel));
+}
+
+void WarpXOpenPMDPlot::CloseStep()
+{
+    if (!m_Series) return;
+#if OPENPMDAPI_VERSION_MAJOR > 0 || OPENPMDAPI_VERSION_MINOR >= 12
+    GetIteration(m_CurrentStep).close();
+#else
+    m_Series->flush();
+#endif
+}
 
+openPMD::Iteration
+WarpXOpenPMDPlot::GetIteration(int iteration) const
+{
+#if openPMD_HAVE_ADIOS2==1 && \
+    (OPENPMDAPI_VERSION_MAJOR > 0 || OPENPMDAPI_VERSION_MINOR >= 12)
+    // streaming engines only accept the iterations in order,
+    // which writeIterations() enforces (and opens the next step of the engine)
+    if( m_OpenPMDFileType == "sst" )
+        return m_Series->writeIterations()[iteration];
+#endif
+    return m_Series->iterations[iteration];
 }
 
 void
@@ -219,6 +272,9 @@ WarpXOpenPMDPlot::Init(openPMD::AccessType accessType, const std::string& filePr
         m_Series = std::make_unique<openPMD::Series>(
             filename, accessType,
             amrex::ParallelDescriptor::Communicator()
+#if OPENPMDAPI_VERSION_MAJOR > 0 || OPENPMDAPI_VERSION_MINOR >= 12
+            , m_OpenPMDOptions
+#endif
         );
         m_MPISize = amrex::ParallelDescriptor::NProcs();
         m_MPIRank = amrex::ParallelDescriptor::MyProc();
@@ -228,7 +284,11 @@ WarpXOpenPMDPlot::Init(openPMD::AccessType accessType, const std::string& filePr
     }
     else
     {
-        m_Series = std::make_unique<openPMD::Series>(filename, accessType);
+        m_Series = std::make_unique<openPMD::Series>(filename, accessType
+#if OPENPMDAPI_VERSION_MAJOR > 0 || OPENPMDAPI_VERSION_MINOR >= 12
+            , m_OpenPMDOptions
+#endif
+        );
         m_MPISize = 1;
         m_MPIRank = 1;
     }
@@ -318,7 +378,7 @@ WarpXOpenPMDPlot::DumpToFile (WarpXParticleContainer* pc,
 
   WarpXParticleCounter counter(pc);
 
-  openPMD::Iteration currIteration = m_Series->iterations[iteration];
+  openPMD::Iteration currIteration = GetIteration(iteration);
   openPMD::ParticleSpecies currSpecies = currIteration.particles[name];
   // meta data for ED-PIC extension
   currSpecies.setAttribute( "particleShape", double( WarpX::noz ) );
@@ -364,53 +424,106 @@ WarpXOpenPMDPlot::DumpToFile (WarpXParticleContainer* pc,
   // open files from all processors, in case some will not contribute below
   m_Series->flush();
 
+  // Gather the particles of all the tiles of this rank into one contiguous
+  // staging buffer per record, so that only one chunk per record and per
+  // level is stored by this rank. The buffers are freed after the flush.
+  int const totalRealAttrs = m_NumAoSRealAttributes + m_NumSoARealAttributes;
+  std::size_t numParticleOnRank = 0;
+  for (auto currentLevel = 0; currentLevel <= pc->finestLevel(); currentLevel++)
+      numParticleOnRank += counter.m_ParticleSizeAtRank[currentLevel];
+
+  std::vector< std::vector< amrex::ParticleReal > > stagingPosition(AMREX_SPACEDIM);
+  for (auto& buffer : stagingPosition)
+      buffer.resize(numParticleOnRank);
+  std::vector< uint64_t > stagingId(numParticleOnRank);
+  std::vector< std::vector< amrex::ParticleReal > > stagingReal(totalRealAttrs);
+  for (int ii = 0; ii < totalRealAttrs; ++ii)
+      if (write_real_comp[ii])
+          stagingReal[ii].resize(numParticleOnRank);
+
+  // The AoS is read as an array of amrex::ParticleReal with a constant
+  // stride, so that each of its real components is deinterleaved by a
+  // strided copy that the compiler vectorizes
+  using PType = WarpXParticleContainer::ParticleType;
+  static_assert(sizeof(PType) % sizeof(amrex::ParticleReal) == 0,
+                "the particle struct must be a whole number of amrex::ParticleReal");
+  constexpr int stride = sizeof(PType) / sizeof(amrex::ParticleReal);
+
+  auto const positionComponents = detail::getParticlePositionComponentLabels();
+  auto const scalar = openPMD::RecordComponent::SCALAR;
+  std::size_t staged = 0;
+
   for (auto currentLevel = 0; currentLevel <= pc->finestLevel(); currentLevel++)
     {
-      uint64_t offset = static_cast<uint64_t>( counter.m_ParticleOffsetAtRank[currentLevel] );
+      uint64_t const offset = static_cast<uint64_t>( counter.m_ParticleOffsetAtRank[currentLevel] );
+      std::size_t const levelBegin = staged;
 
       for (WarpXParIter pti(*pc, currentLevel); pti.isValid(); ++pti) {
          auto const numParticleOnTile = pti.numParticles();
-         uint64_t const numParticleOnTile64 = static_cast<uint64_t>( numParticleOnTile );
-
-         // get position and particle ID from aos
-         // note: this implementation iterates the AoS 4x...
-         // if we flush late as we do now, we can also copy out the data in one go
          const auto& aos = pti.GetArrayOfStructs();  // size =  numParticlesOnTile
-         {
-           // Save positions
-           auto const positionComponents = detail::getParticlePositionComponentLabels();
-           for (auto currDim = 0; currDim < AMREX_SPACEDIM; currDim++) {
-                std::shared_ptr< amrex::ParticleReal > curr(
-                    new amrex::ParticleReal[numParticleOnTile],
-                    [](amrex::ParticleReal const *p){ delete[] p; }
-                );
-                for (auto i=0; i<numParticleOnTile; i++) {
-                     curr.get()[i] = aos[i].m_rdata.pos[currDim];
-                }
-                std::string const positionComponent = positionComponents[currDim];
-                currSpecies["position"][positionComponent].storeChunk(curr, {offset}, {numParticleOnTile64});
-           }
-
-           // save particle ID after converting it to a globally unique ID
-           std::shared_ptr< uint64_t > ids(
-               new uint64_t[numParticleOnTile],
-               [](uint64_t const *p){ delete[] p; }
-           );
-           for (auto i=0; i<numParticleOnTile; i++) {
-               ids.get()[i] = WarpXUtilIO::localIDtoGlobal( aos[i].m_idata.id, aos[i].m_idata.cpu );
-           }
-           auto const scalar = openPMD::RecordComponent::SCALAR;
-           currSpecies["id"][scalar].storeChunk(ids, {offset}, {numParticleOnTile64});
-        }
-         //  save "extra" particle properties in AoS and SoA
-         SaveRealProperty(pti,
-             currSpecies,
-             offset,
-             write_real_comp, real_comp_names);
+         const auto& soa = pti.GetStructOfArrays();
+         amrex::ParticleReal const* AMREX_RESTRICT aosReal =
+             reinterpret_cast<amrex::ParticleReal const*>(aos().data());
+
+         // positions and AoS attributes
+         for (auto currDim = 0; currDim < AMREX_SPACEDIM; currDim++) {
+             amrex::ParticleReal* AMREX_RESTRICT d = stagingPosition[currDim].data() + staged;
+             AMREX_PRAGMA_SIMD
+             for (auto i=0; i<numParticleOnTile; i++)
+                 d[i] = aosReal[i*stride + currDim];
+         }
+         for (auto idx=0; idx<m_NumAoSRealAttributes; idx++) {
+             if (write_real_comp[idx]) {
+                 amrex::ParticleReal* AMREX_RESTRICT d = stagingReal[idx].data() + staged;
+                 AMREX_PRAGMA_SIMD
+                 for (auto i=0; i<numParticleOnTile; i++)
+                     d[i] = aosReal[i*stride + AMREX_SPACEDIM + idx];
+             }
+         }
+
+         // global IDs
+         uint64_t* AMREX_RESTRICT ids = stagingId.data() + staged;
+         AMREX_PRAGMA_SIMD
+         for (auto i=0; i<numParticleOnTile; i++)
+             ids[i] = WarpXUtilIO::localIDtoGlobal( aos[i].m_idata.id, aos[i].m_idata.cpu );
+
+         // SoA attributes are already contiguous per tile
+         for (auto idx=0; idx<m_NumSoARealAttributes; idx++) {
+             auto ii = m_NumAoSRealAttributes + idx;
+             if (write_real_comp[ii]) {
+                 amrex::ParticleReal const* src = soa.GetRealData(idx).data();
+                 std::copy(src, src + numParticleOnTile, stagingReal[ii].data() + staged);
+             }
+         }
+
+         staged += numParticleOnTile;
+      }
+
+      uint64_t const numParticleOnLevel64 = static_cast<uint64_t>( staged - levelBegin );
+      if (numParticleOnLevel64 == 0) continue;
 
-         offset += numParticleOnTile64;
+      for (auto currDim = 0; currDim < AMREX_SPACEDIM; currDim++) {
+          std::string const positionComponent = positionComponents[currDim];
+          currSpecies["position"][positionComponent].storeChunk(
+              openPMD::shareRaw(stagingPosition[currDim].data() + levelBegin),
+              {offset}, {numParticleOnLevel64});
+      }
+      currSpecies["id"][scalar].storeChunk(
+          openPMD::shareRaw(stagingId.data() + levelBegin),
+          {offset}, {numParticleOnLevel64});
+
+      for (int ii = 0; ii < totalRealAttrs; ++ii) {
+          if (write_real_comp[ii]) {
+              // handle scalar and non-scalar records by name
+              std::string record_name, component_name;
+              std::tie(record_name, component_name) = detail::name2openPMD(real_comp_names[ii]);
+              currSpecies[record_name][component_name].storeChunk(
+                  openPMD::shareRaw(stagingReal[ii].data() + levelBegin),
+                  {offset}, {numParticleOnLevel64});
+          }
       }
     }
+    // the staging buffers must stay alive until the data is flushed
     m_Series->flush();
 }
 
@@ -421,6 +534,7 @@ WarpXOpenPMDPlot::SetupRealProperties(openPMD::ParticleSpecies& currSpecies,
                       unsigned long long np) const
 {
   auto particlesLineup = openPMD::Dataset(openPMD::determineDatatype<amrex::ParticleReal>(), {np});
+  SetCompression(particlesLineup);
 
   //
   // the beam/input3d showed write_real_comp.size() = 16 while only 10 real comp names
@@ -461,82 +575,22 @@ WarpXOpenPMDPlot::SetupRealProperties(openPMD::ParticleSpecies& currSpecies,
   }
 }
 
-void
-WarpXOpenPMDPlot::SaveRealProperty(WarpXParIter& pti,
-                       openPMD::ParticleSpecies& currSpecies,
-                       unsigned long long const offset,
-                       amrex::Vector<int> const& write_real_comp,
-                       amrex::Vector<std::string> const& real_comp_names) const
-
-{
-  int numOutputReal = 0;
-  int const totalRealAttrs = m_NumAoSRealAttributes + m_NumSoARealAttributes;
-
-  for( int i = 0; i < totalRealAttrs; ++i )
-    if( write_real_comp[i] )
-      ++numOutputReal;
-
-  auto const numParticleOnTile = pti.numParticles();
-  uint64_t const numParticleOnTile64 = static_cast<uint64_t>( numParticleOnTile );
-  auto const& aos = pti.GetArrayOfStructs();  // size =  numParticlesOnTile
-  auto const& soa = pti.GetStructOfArrays();
-
-  // properties are saved separately
-  {
-    for( auto idx=0; idx<m_NumAoSRealAttributes; idx++ ) {
-      if( write_real_comp[idx] ) {
-          // handle scalar and non-scalar records by name
-          std::string record_name, component_name;
-          std::tie(record_name, component_name) = detail::name2openPMD(real_comp_names[idx]);
-          auto currRecord = currSpecies[record_name];
-          auto currRecordComp = currRecord[component_name];
-
-          std::shared_ptr< amrex::ParticleReal > d(
-              new amrex::ParticleReal[numParticleOnTile],
-              [](amrex::ParticleReal const *p){ delete[] p; }
-          );
-
-          for( auto kk=0; kk<numParticleOnTile; kk++ )
-               d.get()[kk] = aos[kk].m_rdata.arr[AMREX_SPACEDIM+idx];
-
-          currRecordComp.storeChunk(d,
-               {offset}, {numParticleOnTile64});
-      }
-    }
-  }
-
-  {
-    for (auto idx=0; idx<m_NumSoARealAttributes; idx++) {
-      auto ii = m_NumAoSRealAttributes + idx;
-      if (write_real_comp[ii]) {
-          // handle scalar and non-scalar records by name
-          std::string record_name, component_name;
-          std::tie(record_name, component_name) = detail::name2openPMD(real_comp_names[ii]);
-          auto& currRecord = currSpecies[record_name];
-          auto& currRecordComp = currRecord[component_name];
-
-          currRecordComp.storeChunk(openPMD::shareRaw(soa.GetRealData(idx)),
-              {offset}, {numParticleOnTile64});
-      }
-    }
-  }
-}
-
-
-
 void
 WarpXOpenPMDPlot::SetupPos(WarpXParticleContainer* pc,
     openPMD::ParticleSpecies& currSpecies,
     const unsigned long long& np) const
 {
   auto const realType = openPMD::Dataset(openPMD::determineDatatype<amrex::ParticleReal>(), {np});
-  auto const idType = openPMD::Dataset(openPMD::determineDatatype< uint64_t >(), {np});
+  auto positionType = realType;
+  SetCompression(positionType);
+  auto idType = openPMD::Dataset(openPMD::determineDatatype< uint64_t >(), {np});
+  SetCompression(idType);
 
   auto const positionComponents = detail::getParticlePositionComponentLabels();
   for( auto const& comp : positionComponents ) {
       currSpecies["positionOffset"][comp].resetDataset( realType );
       currSpecies["positionOffset"][comp].makeConstant( 0. );
-      currSpecies["position"][comp].resetDataset( realType );
+      currSpecies["position"][comp].resetDataset( positionType );
   }
 
   auto const scalar = openPMD::RecordComponent::SCALAR;
@@ -598,11 +652,13 @@ WarpXOpenPMDPlot::WriteOpenPMDFields( //const std::string& filename,
   std::vector<std::string> axis_labels = detail::getFieldAxisLabels();
 
   // Prepare the type of dataset that will be written
-  openPMD::Datatype const datatype = openPMD::determineDatatype<amrex::Real>();
-  auto const dataset = openPMD::Dataset(datatype, global_size);
+  openPMD::Datatype const datatype = m_SinglePrecisionFields ?
+      openPMD::determineDatatype<float>() : openPMD::determineDatatype<amrex::Real>();
+  auto dataset = openPMD::Dataset(datatype, global_size);
+  SetCompression(dataset);
 
   // meta data
-  auto series_iteration = m_Series->iterations[iteration];
+  auto series_iteration = GetIteration(iteration);
   series_iteration.setTime( time );
 
   // meta data for ED-PIC extension
@@ -721,8 +777,18 @@ WarpXOpenPMDPlot::WriteOpenPMDFields( //const std::string& filename,
 
       // Write local data
       amrex::Real const * local_data = fab.dataPtr( icomp );
-      mesh_comp.storeChunk( openPMD::shareRaw(local_data),
-                            chunk_offset, chunk_size );
+      if (m_SinglePrecisionFields) {
+          // the converted data is owned by openPMD until the flush below
+          auto const npts = local_box.numPts();
+          std::shared_ptr< float > local_data_float(
+              new float[npts], [](float const *p){ delete[] p; } );
+          for (long i = 0; i < npts; ++i)
+              local_data_float.get()[i] = static_cast<float>( local_data[i] );
+          mesh_comp.storeChunk( local_data_float, chunk_offset, chunk_size );
+      } else {
+          mesh_comp.storeChunk( openPMD::shareRaw(local_data),
+                                chunk_offset, chunk_size );
+      }
     }
   }
   // Flush data to disk after looping over all components
@@ -13,6 +13,7 @@
 #include "Utils/WarpXConst.H"
 #include "Utils/WarpXUtil.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Diagnostics/AsyncFlush.H"
 #ifdef WARPX_USE_PY
 #   include "Python/WarpX_py.H"
 #endif
@@ -21,11 +22,20 @@
 #endif
 
 #include <cmath>
+#include <csignal>
 #include <limits>
 
 
 using namespace amrex;
 
+namespace
+{
+    // Signal that asks the run to stop, recorded until the end of the step
+    volatile std::sig_atomic_t stop_signal = 0;
+
+    void RecordStopSignal (int sig) { stop_signal = sig; }
+}
+
 void
 WarpX::Evolve (int numsteps)
 {
@@ -47,6 +57,22 @@ WarpX::Evolve (int numsteps)
 
     bool max_time_reached = false;
     Real walltime, walltime_start = amrex::second();
+
+    // When the reduced diagnostics keep rows in memory and the run is stopped
+    // by a signal (e.g. at the end of the allocation of a batch job), the rows
+    // are written at the end of the current step, before the signal is handled
+    const bool catch_stop_signals = (reduced_diags->m_plot_rd != 0) && reduced_diags->HasBuffers();
+    using SignalHandler = void (*)(int);
+    SignalHandler previous_sigterm = SIG_DFL;
+    SignalHandler previous_sigint = SIG_DFL;
+    if (catch_stop_signals) {
+        previous_sigterm = std::signal(SIGTERM, RecordStopSignal);
+        previous_sigint = std::signal(SIGINT, RecordStopSignal);
+    }
+
+    // The fields may have been modified since the last call (e.g. initialization,
+    // restart or Python), so do not rely on previously exchanged guard cells
+    guard_cells.SetAllStale();
     for (int step = istep[0]; step < numsteps_max && cur_time < stop_time; ++step)
     {
         Real walltime_beg_step = amrex::second();
@@ -57,6 +83,8 @@ WarpX::Evolve (int numsteps)
         amrex::Print() << "\nSTEP " << step+1 << " starts ...\n";
 #ifdef WARPX_USE_PY
         if (warpx_py_beforestep) warpx_py_beforestep();
+        // Python callbacks may modify the fields
+        guard_cells.SetAllStale();
 #endif
 
         amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(0);
@@ -95,7 +123,7 @@ WarpX::Evolve (int numsteps)
             // Not called at each iteration, so exchange all guard cells
             FillBoundaryE(guard_cells.ng_alloc_EB, guard_cells.ng_Extra);
             FillBoundaryB(guard_cells.ng_alloc_EB, guard_cells.ng_Extra);
-            UpdateAuxilaryData();
+            UpdateAuxilaryData(AuxOnlyUsedForGather());
             // on first step, push p by -0.5*dt
             for (int lev = 0; lev <= finest_level; ++lev)
             {
@@ -121,7 +149,7 @@ WarpX::Evolve (int numsteps)
 #ifndef WARPX_USE_PSATD
             FillBoundaryAux(guard_cells.ng_UpdateAux);
 #endif
-            UpdateAuxilaryData();
+            UpdateAuxilaryData(AuxOnlyUsedForGather());
         }
         if (do_subcycling == 0 || finest_level == 0) {
             OneStep_nosub(cur_time);
@@ -143,10 +171,12 @@ WarpX::Evolve (int numsteps)
 
 #ifdef WARPX_USE_PY
         if (warpx_py_beforeEsolve) warpx_py_beforeEsolve();
+        // Python callbacks may modify the fields
+        guard_cells.SetAllStale();
 #endif
         if (cur_time + dt[0] >= stop_time - 1.e-3*dt[0] || step == numsteps_max-1) {
             // At the end of last step, push p by 0.5*dt to synchronize
-            UpdateAuxilaryData();
+            UpdateAuxilaryData(AuxOnlyUsedForGather());
             for (int lev = 0; lev <= finest_level; ++lev) {
                 mypc->PushP(lev, 0.5*dt[lev],
                             *Efield_aux[lev][0],*Efield_aux[lev][1],
@@ -158,6 +188,8 @@ WarpX::Evolve (int numsteps)
         }
 #ifdef WARPX_USE_PY
         if (warpx_py_afterEsolve) warpx_py_afterEsolve();
+        // Python callbacks may modify the fields
+        guard_cells.SetAllStale();
 #endif
 
         for (int lev = 0; lev <= max_level; ++lev) {
@@ -171,7 +203,21 @@ WarpX::Evolve (int numsteps)
         if (do_back_transformed_diagnostics) {
             std::unique_ptr<MultiFab> cell_centered_data = nullptr;
             if (WarpX::do_back_transformed_fields) {
+#ifdef WARPX_DIM_RZ
                 cell_centered_data = GetCellCenteredData();
+#else
+                if (finest_level > 0) {
+                    cell_centered_data = GetCellCenteredData();
+                } else {
+                    // Only compute the cell-centered data in the planes
+                    // of the snapshots that are active at this time
+                    int k_lo, k_hi;
+                    if (myBFD->GetActiveSlabRange(geom[0], cur_time, k_lo, k_hi)) {
+                        cell_centered_data = GetCellCenteredSlabData(
+                            myBFD->boostDirection(), k_lo, k_hi);
+                    }
+                }
+#endif
             }
             myBFD->writeLabFrameData(cell_centered_data.get(), *mypc, geom[0], cur_time, dt[0]);
         }
@@ -206,9 +252,23 @@ WarpX::Evolve (int numsteps)
             }
         }
 
-        if (sort_intervals.contains(step+1)) {
+        // Merge the particles where they became too many
+        mypc->MergeParticles(step+1);
+
+        bool do_sort = sort_intervals.contains(step+1);
+        if (!do_sort && sort_locality_threshold > 0.) {
+            // Sort when the locality of the particles decayed too much
+            // since the last sort (or if they were never sorted)
+            do_sort = (m_sort_locality_ref < 0. ||
+                       mypc->SortLocality(sort_bin_size) <
+                       sort_locality_threshold*m_sort_locality_ref);
+        }
+        if (do_sort) {
             amrex::Print() << "re-sorting particles \n";
             mypc->SortParticlesByBin(sort_bin_size);
+            if (sort_locality_threshold > 0.) {
+                m_sort_locality_ref = mypc->SortLocality(sort_bin_size);
+            }
         }
 
         amrex::Print()<< "STEP " << step+1 << " ends." << " TIME = " << cur_time
@@ -218,6 +278,12 @@ WarpX::Evolve (int numsteps)
         amrex::Print()<< "Walltime = " << walltime
                       << " s; This step = " << walltime_end_step-walltime_beg_step
                       << " s; Avg. per step = " << walltime/(step+1) << " s\n";
+        long exchanged_bytes = guard_cells.PopExchangedBytes();
+        if (verbose > 1) {
+            ParallelDescriptor::ReduceLongSum(exchanged_bytes);
+            amrex::Print()<< "Guard cells of E, B and F exchanged this step = "
+                          << exchanged_bytes << " bytes\n";
+        }
 
         // sync up time
         for (int i = 0; i <= max_level; ++i) {
@@ -233,6 +299,20 @@ WarpX::Evolve (int numsteps)
 
         multi_diags->FilterComputePackFlush( step );
 
+        if (catch_stop_signals) {
+            int sig = stop_signal;
+            ParallelDescriptor::ReduceIntMax(sig);
+            if (sig != 0) {
+                amrex::Print() << "Signal " << sig << " received: writing the reduced diagnostics\n";
+                reduced_diags->FlushBuffers();
+                AsyncFlush::Drain();
+                std::signal(SIGTERM, previous_sigterm);
+                std::signal(SIGINT, previous_sigint);
+                stop_signal = 0;
+                std::raise(sig);
+            }
+        }
+
         if (cur_time >= stop_time - 1.e-3*dt[0]) {
             max_time_reached = true;
             break;
@@ -240,6 +320,8 @@ WarpX::Evolve (int numsteps)
 
 #ifdef WARPX_USE_PY
         if (warpx_py_afterstep) warpx_py_afterstep();
+        // Python callbacks may modify the fields
+        guard_cells.SetAllStale();
 #endif
         // End loop on time steps
     }
@@ -249,6 +331,39 @@ WarpX::Evolve (int numsteps)
     if (do_back_transformed_diagnostics) {
         myBFD->Flush(geom[0]);
     }
+
+    // Write the reduced diagnostics kept in memory
+    if (reduced_diags->m_plot_rd != 0) {
+        reduced_diags->FlushBuffers();
+    }
+    if (catch_stop_signals) {
+        std::signal(SIGTERM, previous_sigterm);
+        std::signal(SIGINT, previous_sigint);
+    }
+
+    // Wait for the diagnostics written in the background
+    AsyncFlush::Drain();
+}
+
+bool
+WarpX::AuxOnlyUsedForGather () const
+{
+#ifdef WARPX_USE_PY
+    // Python may access the aux fields at any time
+    return false;
+#else
+    // With mesh refinement, aux(lev-1) is interpolated to aux(lev)
+    if (finest_level > 0) return false;
+    // Diagnostics that read the aux fields during the step
+    if (do_back_transformed_diagnostics || multi_diags->HasBackTransformed()) return false;
+    if (slice_plot_int > 0) return false;
+    if (reduced_diags->m_plot_rd != 0) return false;
+#ifdef WARPX_QED
+    // The Schwinger process creates particles anywhere from the aux fields
+    if (mypc->hasQEDSchwinger()) return false;
+#endif
+    return true;
+#endif
 }
 
 /* /brief Perform one PIC iteration, without subcycling
@@ -285,11 +400,19 @@ WarpX::OneStep_nosub (Real cur_time)
     if (warpx_py_particleinjection) warpx_py_particleinjection();
     if (warpx_py_particlescraper) warpx_py_particlescraper();
     if (warpx_py_beforedeposition) warpx_py_beforedeposition();
+    // Python callbacks may modify the fields
+    guard_cells.SetAllStale();
+    // and the particles, so the fields stored by the ionization are not reused
+    if (warpx_py_particleinjection || warpx_py_particlescraper || warpx_py_beforedeposition) {
+        mypc->ClearIonizationGather();
+    }
 #endif
     PushParticlesandDepose(cur_time);
 
 #ifdef WARPX_USE_PY
     if (warpx_py_afterdeposition) warpx_py_afterdeposition();
+    // Python callbacks may modify the fields
+    guard_cells.SetAllStale();
 #endif
 
 // TODO
@@ -744,6 +867,7 @@ WarpX::computeMaxStepBoostAccelerator(const amrex::Geometry& a_geom){
  */
 void
 WarpX::applyMirrors(Real time){
+    guard_cells.SetAllStale();
     // Loop over the mirrors
     for(int i_mirror=0; i_mirror<num_mirrors; ++i_mirror){
         // Get mirror properties (lower and upper z bounds)
@@ -11,11 +11,16 @@
 
 #include <WarpX.H>
 
+#include <algorithm>
+#include <limits>
+
 using namespace amrex;
 
 void
 WarpX::ComputeSpaceChargeField (bool const reset_fields)
 {
+    guard_cells.SetAllStale();
+
     if (reset_fields) {
         // Reset all E and B fields to 0, before calculating space-charge fields
         for (int lev = 0; lev <= max_level; lev++) {
@@ -26,6 +31,12 @@ WarpX::ComputeSpaceChargeField (bool const reset_fields)
         }
     }
 
+    if (do_electrostatic && do_persistent_phi) {
+        // Electrostatic time stepping: single Poisson solve for the total
+        // charge density of all species, if they move at the same velocity
+        if (AddSpaceChargeFieldLabFrame()) return;
+    }
+
     // Loop over the species and add their space-charge contribution to E and B
     for (int ispecies=0; ispecies<mypc->nSpecies(); ispecies++){
         WarpXParticleContainer& species = mypc->GetParticleContainer(ispecies);
@@ -76,6 +87,70 @@ WarpX::AddSpaceChargeField (WarpXParticleContainer& pc)
 
 }
 
+bool
+WarpX::AddSpaceChargeFieldLabFrame ()
+{
+#ifdef WARPX_DIM_RZ
+    amrex::Abort("The electrostatic solver has not yet been implemented in RZ geometry.");
+#endif
+
+    // Mean velocity of each species, and most stringent precision requested
+    // by the species
+    Real required_precision = std::numeric_limits<Real>::max();
+    Vector<std::array<Real, 3> > beta_species;
+    Vector<Real> np_species;
+    for (int ispecies=0; ispecies<mypc->nSpecies(); ispecies++){
+        WarpXParticleContainer& species = mypc->GetParticleContainer(ispecies);
+        required_precision = std::min(required_precision, species.self_fields_required_precision);
+        const Real np = static_cast<Real>(species.TotalNumberOfParticles());
+        if (np == 0.) continue;
+        bool const local_average = false; // Average across all MPI ranks
+        std::array<Real, 3> beta_s = species.meanParticleVelocity(local_average);
+        for (Real& beta_comp : beta_s) beta_comp /= PhysConst::c; // Normalize
+        beta_species.push_back(beta_s);
+        np_species.push_back(np);
+    }
+    if (mypc->nSpecies() == 0) required_precision = 1.e-11;
+
+    // Mean velocity of the total charge, weighted by the number of
+    // macroparticles of each species
+    std::array<Real, 3> beta = {{0., 0., 0.}};
+    Real np_total = 0.;
+    for (int is = 0; is < beta_species.size(); ++is) {
+        for (int idim=0; idim<3; idim++) beta[idim] += np_species[is]*beta_species[is][idim];
+        np_total += np_species[is];
+    }
+    if (np_total > 0.) {
+        for (Real& beta_comp : beta) beta_comp /= np_total;
+    }
+
+    // The operator of the Poisson equation depends on beta through the
+    // products beta_i*beta_j: a single solve for all species is only done if
+    // they differ by less than the requested precision for every species.
+    // Otherwise, each species is solved with its own beta by the caller.
+    for (const auto& beta_s : beta_species) {
+        for (int i=0; i<3; i++) {
+            for (int j=0; j<3; j++) {
+                if (std::abs(beta_s[i]*beta_s[j] - beta[i]*beta[j]) > required_precision) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Deposit the charge density of all species in the persistent rho_es_fp
+    mypc->DepositCharge(rho_es_fp);
+
+    // Compute the potential phi, starting from its value at the previous step
+    computePhiPersistent( rho_es_fp, phi_fp, beta, required_precision );
+
+    // Compute the corresponding electric and magnetic field, from the potential phi
+    computeE( Efield_fp, phi_fp, beta );
+    computeB( Bfield_fp, phi_fp, beta );
+
+    return true;
+}
+
 /* Compute the potential `phi` by solving the Poisson equation with `rho` as
    a source, assuming that the source moves at a constant speed \f$\vec{\beta}\f$.
    This uses the amrex solver.
@@ -132,6 +207,100 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
     }
 }
 
+/* Compute the potential `phi` by solving the Poisson equation with `rho` as
+   a source, with the same equation as in computePhi.
+
+   The linear operator and the MLMG solver are built on the first call, and
+   reused in subsequent calls as long as the grids and distribution mappings
+   are unchanged. The content of `phi` on input is used as initial guess of
+   the iterative solver (warm start), which typically reduces the number of
+   V-cycles when the charge density evolves slowly from one step to the next.
+
+   \param[inout] rho The total charge density ; overwritten by -rho/epsilon_0
+   \param[inout] phi On input, the initial guess ; on output, the potential
+   \param[in] beta Represents the velocity of the source of `phi`
+*/
+void
+WarpX::computePhiPersistent (amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
+                             amrex::Vector<std::unique_ptr<amrex::MultiFab> >& phi,
+                             std::array<Real, 3> const beta,
+                             Real const required_precision)
+{
+    // Only the levels that exist are allocated (see AllocLevelData)
+    const int num_levels = finest_level + 1;
+
+    // Rebuild the solver if the grids have changed since the last solve
+    bool grids_changed = (poisson_mlmg == nullptr) ||
+                         (static_cast<int>(poisson_grids.size()) != num_levels);
+    for (int lev = 0; lev < num_levels && !grids_changed; lev++) {
+        grids_changed = (poisson_grids[lev] != boxArray(lev)) ||
+                        (poisson_dmap[lev] != DistributionMap(lev));
+    }
+
+    if (grids_changed) {
+        ResetPoissonSolver();
+
+        // Define the boundary conditions
+        Array<LinOpBCType,AMREX_SPACEDIM> lobc, hibc;
+        for (int idim=0; idim<AMREX_SPACEDIM; idim++){
+            if ( Geom(0).isPeriodic(idim) ) {
+                lobc[idim] = LinOpBCType::Periodic;
+                hibc[idim] = LinOpBCType::Periodic;
+            } else {
+                // Use Dirichlet boundary condition by default.
+                lobc[idim] = LinOpBCType::Dirichlet;
+                hibc[idim] = LinOpBCType::Dirichlet;
+            }
+        }
+
+        poisson_grids.resize(num_levels);
+        poisson_dmap.resize(num_levels);
+        for (int lev = 0; lev < num_levels; lev++) {
+            poisson_grids[lev] = boxArray(lev);
+            poisson_dmap[lev] = DistributionMap(lev);
+        }
+        const Vector<Geometry> poisson_geom(Geom().begin(), Geom().begin()+num_levels);
+        poisson_linop.reset( new MLNodeTensorLaplacian( poisson_geom, poisson_grids, poisson_dmap ) );
+        poisson_linop->setDomainBC( lobc, hibc );
+        poisson_mlmg.reset( new MLMG(*poisson_linop) );
+        poisson_mlmg->setVerbose(2);
+    }
+
+    // Set the value of beta (may change from one step to the next)
+    amrex::Array<amrex::Real,AMREX_SPACEDIM> beta_solver =
+#if (AMREX_SPACEDIM==2)
+        {{ beta[0], beta[2] }};  // beta_x and beta_z
+#else
+        {{ beta[0], beta[1], beta[2] }};
+#endif
+    poisson_linop->setBeta( beta_solver );
+
+    // Normalize the source by the physical constant, so that `phi` needs no
+    // rescaling after the solve and can be used as is for the next initial guess
+    for (int lev=0; lev < num_levels; lev++){
+        rho[lev]->mult(-1./PhysConst::ep0);
+    }
+
+    // Solve the Poisson equation, starting from the current value of phi
+    Vector<MultiFab*> phi_levels(num_levels);
+    Vector<MultiFab const*> rho_levels(num_levels);
+    for (int lev=0; lev < num_levels; lev++){
+        phi_levels[lev] = phi[lev].get();
+        rho_levels[lev] = rho[lev].get();
+    }
+    poisson_mlmg->solve( phi_levels, rho_levels, required_precision, 0.0);
+}
+
+void
+WarpX::ResetPoissonSolver ()
+{
+    // The MLMG object holds a reference to the linear operator: delete it first
+    poisson_mlmg.reset();
+    poisson_linop.reset();
+    poisson_grids.clear();
+    poisson_dmap.clear();
+}
+
 /* \bried Compute the electric field that corresponds to `phi`, and
           add it to the set of MultiFab `E`.
 
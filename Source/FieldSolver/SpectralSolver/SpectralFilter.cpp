@@ -0,0 +1,152 @@
+/* Copyright 2020 The WarpX Community
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "SpectralFilter.H"
+#include "WarpX.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/WarpXProfilerWrapper.H"
+#include "Parser/WarpXParserWrapper.H"
+
+#include <cmath>
+#include <memory>
+
+
+#ifdef WARPX_USE_PSATD
+using namespace amrex;
+
+/* \brief Compute the transfer function of the filter, on the spectral boxes
+ *
+ * \param k_space Spectral space (contains the spectral boxes)
+ * \param realspace_ba Cell-centered real-space boxes (including guard cells)
+ * \param dm Distribution mapping of the boxes
+ * \param dx Cell size in real space
+ */
+SpectralFilter::SpectralFilter (const SpectralKSpace& k_space,
+                                const BoxArray& realspace_ba,
+                                const DistributionMapping& dm,
+                                const RealVect dx)
+{
+    ParmParse pp("psatd");
+    const int filter_type = GetAlgorithmInteger(pp, "spectral_filter");
+
+    // Parameters of the different transfer functions, in each direction
+    // (index 0: x, index 1: y in 3D and z in 2D, index 2: z in 3D)
+    const IntVect npass = WarpX::filter_npass_each_dir;
+    bool compensation = false;
+    pp.query("spectral_filter_compensation", compensation);
+    Vector<Real> width(AMREX_SPACEDIM, 1._rt);
+    pp.queryarr("spectral_filter_width", width);
+    Vector<Real> cutoff(AMREX_SPACEDIM, 0.5_rt);
+    pp.queryarr("spectral_filter_cutoff", cutoff);
+
+    std::unique_ptr<ParserWrapper<3> > filter_parser;
+    if (filter_type == SpectralFilterType::ParserFunction) {
+        std::string str_filter_function;
+        Store_parserString(pp, "filter_function(kx,ky,kz)", str_filter_function);
+        filter_parser.reset(new ParserWrapper<3>(
+            makeParser(str_filter_function, {"kx","ky","kz"})));
+    }
+    ParserWrapper<3>* const parser = filter_parser.get();
+
+    // Exact wavenumbers (not the modified finite-order ones)
+    const KVectorComponent kx_vec = k_space.getKComponent(dm, realspace_ba, 0, true);
+#if (AMREX_SPACEDIM==3)
+    const KVectorComponent ky_vec = k_space.getKComponent(dm, realspace_ba, 1, false);
+    const KVectorComponent kz_vec = k_space.getKComponent(dm, realspace_ba, 2, false);
+#else
+    const KVectorComponent kz_vec = k_space.getKComponent(dm, realspace_ba, 1, false);
+#endif
+
+    const BoxArray& ba = k_space.spectralspace_ba;
+    m_transfer_function = amrex::FabArray< amrex::BaseFab<Real> >(ba, dm, 1, 0);
+
+    const GpuArray<Real,AMREX_SPACEDIM> dx_arr = {AMREX_D_DECL(dx[0], dx[1], dx[2])};
+    const GpuArray<int,AMREX_SPACEDIM> npass_arr = {AMREX_D_DECL(npass[0], npass[1], npass[2])};
+    const GpuArray<Real,AMREX_SPACEDIM> width_arr = {AMREX_D_DECL(width[0], width[1], width[2])};
+    const GpuArray<Real,AMREX_SPACEDIM> cutoff_arr = {AMREX_D_DECL(cutoff[0], cutoff[1], cutoff[2])};
+
+    for (MFIter mfi(ba, dm); mfi.isValid(); ++mfi){
+
+        const Box& bx = ba[mfi];
+
+        // Extract pointers for the k vectors
+        const Real* kx = kx_vec[mfi].dataPtr();
+#if (AMREX_SPACEDIM==3)
+        const Real* ky = ky_vec[mfi].dataPtr();
+#endif
+        const Real* kz = kz_vec[mfi].dataPtr();
+
+        Array4<Real> T = m_transfer_function[mfi].array();
+
+        ParallelFor( bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept
+        {
+#if (AMREX_SPACEDIM==3)
+            const Real kvec[3] = {kx[i], ky[j], kz[k]};
+#else
+            const Real kvec[2] = {kx[i], kz[j]};
+#endif
+            Real t = 1._rt;
+            if (filter_type == SpectralFilterType::ParserFunction) {
+#if (AMREX_SPACEDIM==3)
+                t = (*parser)(kvec[0], kvec[1], kvec[2]);
+#else
+                t = (*parser)(kvec[0], 0._rt, kvec[1]);
+#endif
+            } else {
+                for (int idim=0; idim<AMREX_SPACEDIM; idim++){
+                    // Normalized wavenumber, in [-pi, pi]
+                    const Real kdx = kvec[idim]*dx_arr[idim];
+                    if (filter_type == SpectralFilterType::Bilinear) {
+                        // One pass of the 1-2-1 stencil multiplies by cos^2(k*dx/2)
+                        const Real s = std::sin(0.5_rt*kdx);
+                        const Real c2 = 1._rt - s*s;
+                        for (int ipass=0; ipass<npass_arr[idim]; ipass++) t *= c2;
+                        // Compensation step: flattens the transfer function at low k
+                        if (compensation) t *= 1._rt + npass_arr[idim]*s*s;
+                    } else if (filter_type == SpectralFilterType::Gaussian) {
+                        const Real a = kdx*width_arr[idim];
+                        t *= std::exp(-0.5_rt*a*a);
+                    } else if (filter_type == SpectralFilterType::Cutoff) {
+                        if (std::abs(kdx) > cutoff_arr[idim]*MathConst::pi) t = 0._rt;
+                    }
+                }
+            }
+            T(i,j,k) = t;
+        });
+    }
+    // Make sure that the parser is not deleted before the end of the kernels
+    Gpu::synchronize();
+}
+
+/* \brief Multiply the current and charge density in spectral space by the
+ * transfer function of the filter
+ */
+void
+SpectralFilter::ApplyToSources (SpectralFieldData& field_data) const
+{
+    WARPX_PROFILE("SpectralFilter::ApplyToSources");
+
+    using Idx = SpectralFieldIndex;
+    for (MFIter mfi(field_data.fields); mfi.isValid(); ++mfi){
+
+        const Box& bx = field_data.fields[mfi].box();
+        Array4<Complex> fields = field_data.fields[mfi].array();
+        Array4<const Real> T = m_transfer_function[mfi].array();
+
+        ParallelFor( bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept
+        {
+            const Real t = T(i,j,k);
+            fields(i,j,k,Idx::Jx) *= t;
+            fields(i,j,k,Idx::Jy) *= t;
+            fields(i,j,k,Idx::Jz) *= t;
+            fields(i,j,k,Idx::rho_old) *= t;
+            fields(i,j,k,Idx::rho_new) *= t;
+        });
+    }
+}
+#endif // WARPX_USE_PSATD
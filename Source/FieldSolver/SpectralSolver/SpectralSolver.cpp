@@ -80,6 +80,12 @@ SpectralSolver::SpectralSolver(
     field_data = SpectralFieldData( realspace_ba, k_space, dm,
             algorithm->getRequiredNumberOfFields(), periodic_single_box );
 
+    // - Initialize the filter of the sources in spectral space
+    //   (not needed in the PML, where there are no sources)
+    if (WarpX::use_spectral_filter && !pml) {
+        m_filter.reset( new SpectralFilter( k_space, realspace_ba, dm, dx ) );
+    }
+
 }
 
 void
@@ -106,6 +112,7 @@ SpectralSolver::pushSpectralFields(){
     // Virtual function: the actual function used here depends
     // on the sub-class of `SpectralBaseAlgorithm` that was
     // initialized in the constructor of `SpectralSolver`
+    if (m_filter) m_filter->ApplyToSources( field_data );
     algorithm->pushSpectralFields( field_data );
 }
 
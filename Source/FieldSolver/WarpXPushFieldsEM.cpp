@@ -121,6 +121,14 @@ WarpX::PushPSATD (amrex::Real a_dt)
 void
 WarpX::PushPSATD (int lev, amrex::Real /* dt */)
 {
+    for (int patch = 0; patch < 2; ++patch) {
+        guard_cells.SetStale(guardCellManager::FieldType::E, lev, patch);
+        guard_cells.SetStale(guardCellManager::FieldType::B, lev, patch);
+        guard_cells.SetStale(guardCellManager::FieldType::F, lev, patch);
+        guard_cells.SetStale(guardCellManager::FieldType::E_avg, lev, patch);
+        guard_cells.SetStale(guardCellManager::FieldType::B_avg, lev, patch);
+    }
+
     // Update the fields on the fine and coarse patch
     PushPSATDSinglePatch( *spectral_solver_fp[lev],
         Efield_fp[lev], Bfield_fp[lev], Efield_avg_fp[lev], Bfield_avg_fp[lev], current_fp[lev], rho_fp[lev] );
@@ -153,6 +161,7 @@ WarpX::EvolveB (int lev, amrex::Real a_dt)
 void
 WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real a_dt)
 {
+    guard_cells.SetStale(guardCellManager::FieldType::B, lev, static_cast<int>(patch_type));
 
     // Evolve B field in regular cells
     if (patch_type == PatchType::fine) {
@@ -197,6 +206,8 @@ WarpX::EvolveE (int lev, amrex::Real a_dt)
 void
 WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real a_dt)
 {
+    guard_cells.SetStale(guardCellManager::FieldType::E, lev, static_cast<int>(patch_type));
+
     // Evolve E field in regular cells
     if (patch_type == PatchType::fine) {
         m_fdtd_solver_fp[lev]->EvolveE( Efield_fp[lev], Bfield_fp[lev],
@@ -250,6 +261,8 @@ WarpX::EvolveF (int lev, PatchType patch_type, amrex::Real a_dt, DtType a_dt_typ
 {
     if (!do_dive_cleaning) return;
 
+    guard_cells.SetStale(guardCellManager::FieldType::F, lev, static_cast<int>(patch_type));
+
     WARPX_PROFILE("WarpX::EvolveF()");
 
     const int rhocomp = (a_dt_type == DtType::FirstHalf) ? 0 : 1;
@@ -296,6 +309,7 @@ WarpX::MacroscopicEvolveE (int lev, amrex::Real a_dt) {
 
 void
 WarpX::MacroscopicEvolveE (int lev, PatchType patch_type, amrex::Real a_dt) {
+    guard_cells.SetStale(guardCellManager::FieldType::E, lev, static_cast<int>(patch_type));
     if (patch_type == PatchType::fine) {
         m_fdtd_solver_fp[lev]->MacroscopicEvolveE( Efield_fp[lev], Bfield_fp[lev],
                                              current_fp[lev], a_dt,
@@ -58,6 +58,8 @@ WarpX::Hybrid_QED_Push (int lev, Real a_dt)
 void
 WarpX::Hybrid_QED_Push (int lev, PatchType patch_type, Real a_dt)
 {
+    guard_cells.SetStale(guardCellManager::FieldType::E, lev, static_cast<int>(patch_type));
+
     const int patch_level = (patch_type == PatchType::fine) ? lev : lev-1;
     const std::array<Real,3>& dx_vec= WarpX::CellSize(patch_level);
     const Real dx = dx_vec[0];
@@ -103,6 +103,10 @@ void Filter::DoFilter (const Box& tbx,
                        Array4<Real      > const& dst,
                        int scomp, int dcomp, int ncomp)
 {
+    if (slen.x*slen.y*slen.z > max_dense_stencil_size) {
+        DoFilterSeparable(tbx, tmp, dst, scomp, dcomp, ncomp);
+        return;
+    }
     amrex::Real const* AMREX_RESTRICT sx = stencil_x.data();
 #if (AMREX_SPACEDIM == 3)
     amrex::Real const* AMREX_RESTRICT sy = stencil_y.data();
@@ -211,6 +215,10 @@ void Filter::DoFilter (const Box& tbx,
                        Array4<Real      > const& dst,
                        int scomp, int dcomp, int ncomp)
 {
+    if (slen.x*slen.y*slen.z > max_dense_stencil_size) {
+        DoFilterSeparable(tbx, tmp, dst, scomp, dcomp, ncomp);
+        return;
+    }
     const auto lo = amrex::lbound(tbx);
     const auto hi = amrex::ubound(tbx);
     // tmp and dst are of type Array4 (Fortran ordering)
@@ -267,3 +275,79 @@ void Filter::DoFilter (const Box& tbx,
 }
 
 #endif // #ifdef AMREX_USE_CUDA
+
+/* \brief Apply stencil as a sequence of 1D filters (2D/3D, CPU/GPU).
+ * Since the stencil is the tensor product of the 1D stencils along each
+ * direction, this gives the same result as DoFilter, but the number of
+ * operations per cell scales with the sum (instead of the product) of
+ * the stencil lengths.
+ */
+void Filter::DoFilterSeparable (const Box& tbx,
+                                Array4<Real const> const& tmp,
+                                Array4<Real      > const& dst,
+                                int scomp, int dcomp, int ncomp)
+{
+    // In 2D, the second direction of the arrays is z
+    amrex::Real const* AMREX_RESTRICT s0 = stencil_x.data();
+#if (AMREX_SPACEDIM == 3)
+    amrex::Real const* AMREX_RESTRICT s1 = stencil_y.data();
+    amrex::Real const* AMREX_RESTRICT s2 = stencil_z.data();
+#else
+    amrex::Real const* AMREX_RESTRICT s1 = stencil_z.data();
+#endif
+    Dim3 slen_local = slen;
+
+    // Filter along the first direction, on the tile box grown in the other directions
+    const Box& bx0 = amrex::grow(tbx, IntVect(AMREX_D_DECL(0, slen.y-1, slen.z-1)));
+    FArrayBox fab0(bx0, ncomp);
+    Elixir eli0 = fab0.elixir();  // Prevent the tmp data from being deleted too early
+    auto const& t0 = fab0.array();
+    amrex::ParallelFor(bx0, ncomp,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        Real d = 0.0;
+        for (int ix=0; ix < slen_local.x; ++ix){
+            d += s0[ix]*(tmp(i-ix,j,k,scomp+n) + tmp(i+ix,j,k,scomp+n));
+        }
+        t0(i,j,k,n) = d;
+    });
+
+#if (AMREX_SPACEDIM == 3)
+    // Filter along y
+    const Box& bx1 = amrex::grow(tbx, IntVect(0, 0, slen.z-1));
+    FArrayBox fab1(bx1, ncomp);
+    Elixir eli1 = fab1.elixir();
+    auto const& t1 = fab1.array();
+    amrex::ParallelFor(bx1, ncomp,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        Real d = 0.0;
+        for (int iy=0; iy < slen_local.y; ++iy){
+            d += s1[iy]*(t0(i,j-iy,k,n) + t0(i,j+iy,k,n));
+        }
+        t1(i,j,k,n) = d;
+    });
+
+    // Filter along z
+    amrex::ParallelFor(tbx, ncomp,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        Real d = 0.0;
+        for (int iz=0; iz < slen_local.z; ++iz){
+            d += s2[iz]*(t1(i,j,k-iz,n) + t1(i,j,k+iz,n));
+        }
+        dst(i,j,k,dcomp+n) = d;
+    });
+#else
+    // Filter along z
+    amrex::ParallelFor(tbx, ncomp,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+    {
+        Real d = 0.0;
+        for (int iz=0; iz < slen_local.y; ++iz){
+            d += s1[iz]*(t0(i,j-iz,k,n) + t0(i,j+iz,k,n));
+        }
+        dst(i,j,k,dcomp+n) = d;
+    });
+#endif
+}
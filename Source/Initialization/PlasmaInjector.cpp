@@ -509,9 +509,9 @@ void PlasmaInjector::parseMomentum (ParmParse& pp)
     }
 }
 
-XDim3 PlasmaInjector::getMomentum (Real x, Real y, Real z) const noexcept
+XDim3 PlasmaInjector::getMomentum (Real x, Real y, Real z, RandomStream& rng) const noexcept
 {
-    return inj_mom->getMomentum(x, y, z); // gamma*beta
+    return inj_mom->getMomentum(x, y, z, rng); // gamma*beta
 }
 
 bool PlasmaInjector::insideBounds (Real x, Real y, Real z) const noexcept
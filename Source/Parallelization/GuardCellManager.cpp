@@ -25,8 +25,12 @@ guardCellManager::Init(
     const int maxwell_fdtd_solver_id,
     const int max_level,
     const amrex::Array<amrex::Real,3> v_galilean,
-    const bool safe_guard_cells)
+    const bool safe_guard_cells,
+    const bool lazy_exchange)
 {
+    m_lazy_exchange = lazy_exchange;
+    SetAllStale();
+
     // When using subcycling, the particles on the fine level perform two pushes
     // before being redistributed ; therefore, we need one extra guard cell
     // (the particles may move by 2*c*dt)
@@ -189,3 +193,42 @@ guardCellManager::Init(
         }
     }
 }
+
+bool
+guardCellManager::NeedsExchange (int field, int lev, int patch, const IntVect& ng) const
+{
+    if (!m_lazy_exchange) return true;
+    const auto it = m_ng_exchanged.find({field, lev, patch});
+    if (it == m_ng_exchanged.end()) return true;
+    return !ng.allLE(it->second);
+}
+
+void
+guardCellManager::SetExchanged (int field, int lev, int patch, const MultiFab& mf,
+                                const IntVect& ng)
+{
+    // Count the guard cells filled on this rank (including physical boundaries)
+    long npts = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        npts += amrex::grow(bx, ng).numPts() - bx.numPts();
+    }
+    m_exchanged_bytes += npts * mf.nComp() * static_cast<long>(sizeof(Real));
+
+    if (!m_lazy_exchange) return;
+    m_ng_exchanged[{field, lev, patch}] = ng;
+}
+
+void
+guardCellManager::SetStale (int field, int lev, int patch)
+{
+    m_ng_exchanged.erase({field, lev, patch});
+}
+
+long
+guardCellManager::PopExchangedBytes ()
+{
+    const long nbytes = m_exchanged_bytes;
+    m_exchanged_bytes = 0;
+    return nbytes;
+}
@@ -55,26 +55,46 @@ WarpX::ExchangeWithPmlF (int lev)
 }
 
 void
-WarpX::UpdateAuxilaryData ()
+WarpX::UpdateAuxilaryData (bool only_boxes_with_particles)
 {
     WARPX_PROFILE("UpdateAuxilaryData()");
 
     if (Bfield_aux[0][0]->ixType() == Bfield_fp[0][0]->ixType()) {
         UpdateAuxilaryDataSameType();
     } else {
-        UpdateAuxilaryDataStagToNodal();
+        UpdateAuxilaryDataStagToNodal(only_boxes_with_particles);
     }
 }
 
 void
-WarpX::UpdateAuxilaryDataStagToNodal ()
+WarpX::UpdateAuxilaryDataStagToNodal (bool only_boxes_with_particles)
 {
+    // With a single level, the particles only gather the aux fields from the
+    // grid they are in: the grids without particles do not need to be updated.
+    // (With mesh refinement, the aux fields of level 0 are interpolated to
+    // the finer levels, so all grids are needed.)
+    LayoutData<int> has_particles(Bfield_aux[0][0]->boxArray(),
+                                  Bfield_aux[0][0]->DistributionMap());
+    const bool skip_empty_boxes = only_boxes_with_particles && finest_level == 0;
+    if (skip_empty_boxes) {
+        for (MFIter mfi(has_particles); mfi.isValid(); ++mfi) {
+            has_particles[mfi] = 0;
+        }
+        for (int i = 0; i < mypc->nSpecies(); ++i) {
+            for (const auto& kv : mypc->GetParticleContainer(i).GetParticles(0)) {
+                if (kv.second.numParticles() > 0) has_particles[kv.first.first] = 1;
+            }
+        }
+    }
+
     // For level 0, we only need to do the average.
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
     for (MFIter mfi(*Bfield_aux[0][0]); mfi.isValid(); ++mfi)
     {
+        if (skip_empty_boxes && !has_particles[mfi]) continue;
+
         Array4<Real> const& bx_aux = Bfield_aux[0][0]->array(mfi);
         Array4<Real> const& by_aux = Bfield_aux[0][1]->array(mfi);
         Array4<Real> const& bz_aux = Bfield_aux[0][2]->array(mfi);
@@ -381,6 +401,9 @@ WarpX::FillBoundaryE(int lev, IntVect ng, IntVect ng_extra_fine)
 void
 WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng)
 {
+    const int patch = static_cast<int>(patch_type);
+    if (!guard_cells.NeedsExchange(guardCellManager::FieldType::E, lev, patch, ng)) return;
+
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -397,6 +420,10 @@ WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng)
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Efield_fp[lev][0].get(),Efield_fp[lev][1].get(),Efield_fp[lev][2].get()};
             amrex::FillBoundary(mf, period);
+            for (auto* pmf : mf) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::E, lev, patch,
+                                         *pmf, pmf->nGrowVect());
+            }
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Efield_fp[lev][0]->nGrowVect(),
@@ -404,6 +431,10 @@ WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng)
             Efield_fp[lev][0]->FillBoundary(ng, period);
             Efield_fp[lev][1]->FillBoundary(ng, period);
             Efield_fp[lev][2]->FillBoundary(ng, period);
+            for (int i = 0; i < 3; ++i) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::E, lev, patch,
+                                         *Efield_fp[lev][i], ng);
+            }
         }
     }
     else if (patch_type == PatchType::coarse)
@@ -421,6 +452,10 @@ WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng)
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Efield_cp[lev][0].get(),Efield_cp[lev][1].get(),Efield_cp[lev][2].get()};
             amrex::FillBoundary(mf, cperiod);
+            for (auto* pmf : mf) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::E, lev, patch,
+                                         *pmf, pmf->nGrowVect());
+            }
 
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
@@ -429,6 +464,10 @@ WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng)
             Efield_cp[lev][0]->FillBoundary(ng, cperiod);
             Efield_cp[lev][1]->FillBoundary(ng, cperiod);
             Efield_cp[lev][2]->FillBoundary(ng, cperiod);
+            for (int i = 0; i < 3; ++i) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::E, lev, patch,
+                                         *Efield_cp[lev][i], ng);
+            }
         }
     }
 }
@@ -443,6 +482,9 @@ WarpX::FillBoundaryB (int lev, IntVect ng, IntVect ng_extra_fine)
 void
 WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng)
 {
+    const int patch = static_cast<int>(patch_type);
+    if (!guard_cells.NeedsExchange(guardCellManager::FieldType::B, lev, patch, ng)) return;
+
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -458,6 +500,10 @@ WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng)
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Bfield_fp[lev][0].get(),Bfield_fp[lev][1].get(),Bfield_fp[lev][2].get()};
             amrex::FillBoundary(mf, period);
+            for (auto* pmf : mf) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::B, lev, patch,
+                                         *pmf, pmf->nGrowVect());
+            }
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Bfield_fp[lev][0]->nGrowVect(),
@@ -465,6 +511,10 @@ WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng)
             Bfield_fp[lev][0]->FillBoundary(ng, period);
             Bfield_fp[lev][1]->FillBoundary(ng, period);
             Bfield_fp[lev][2]->FillBoundary(ng, period);
+            for (int i = 0; i < 3; ++i) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::B, lev, patch,
+                                         *Bfield_fp[lev][i], ng);
+            }
         }
     }
     else if (patch_type == PatchType::coarse)
@@ -482,6 +532,10 @@ WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng)
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Bfield_cp[lev][0].get(),Bfield_cp[lev][1].get(),Bfield_cp[lev][2].get()};
             amrex::FillBoundary(mf, cperiod);
+            for (auto* pmf : mf) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::B, lev, patch,
+                                         *pmf, pmf->nGrowVect());
+            }
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Bfield_cp[lev][0]->nGrowVect(),
@@ -489,6 +543,10 @@ WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng)
             Bfield_cp[lev][0]->FillBoundary(ng, cperiod);
             Bfield_cp[lev][1]->FillBoundary(ng, cperiod);
             Bfield_cp[lev][2]->FillBoundary(ng, cperiod);
+            for (int i = 0; i < 3; ++i) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::B, lev, patch,
+                                         *Bfield_cp[lev][i], ng);
+            }
         }
     }
 }
@@ -503,6 +561,9 @@ WarpX::FillBoundaryE_avg(int lev, IntVect ng, IntVect ng_extra_fine)
 void
 WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
 {
+    const int patch = static_cast<int>(patch_type);
+    if (!guard_cells.NeedsExchange(guardCellManager::FieldType::E_avg, lev, patch, ng)) return;
+
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -514,6 +575,10 @@ WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Efield_avg_fp[lev][0].get(),Efield_avg_fp[lev][1].get(),Efield_avg_fp[lev][2].get()};
             amrex::FillBoundary(mf, period);
+            for (auto* pmf : mf) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::E_avg, lev, patch,
+                                         *pmf, pmf->nGrowVect());
+            }
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Efield_avg_fp[lev][0]->nGrowVect(),
@@ -521,6 +586,10 @@ WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
             Efield_avg_fp[lev][0]->FillBoundary(ng, period);
             Efield_avg_fp[lev][1]->FillBoundary(ng, period);
             Efield_avg_fp[lev][2]->FillBoundary(ng, period);
+            for (int i = 0; i < 3; ++i) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::E_avg, lev, patch,
+                                         *Efield_avg_fp[lev][i], ng);
+            }
         }
     }
     else if (patch_type == PatchType::coarse)
@@ -534,6 +603,10 @@ WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Efield_avg_cp[lev][0].get(),Efield_avg_cp[lev][1].get(),Efield_avg_cp[lev][2].get()};
             amrex::FillBoundary(mf, cperiod);
+            for (auto* pmf : mf) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::E_avg, lev, patch,
+                                         *pmf, pmf->nGrowVect());
+            }
 
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
@@ -542,6 +615,10 @@ WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
             Efield_avg_cp[lev][0]->FillBoundary(ng, cperiod);
             Efield_avg_cp[lev][1]->FillBoundary(ng, cperiod);
             Efield_avg_cp[lev][2]->FillBoundary(ng, cperiod);
+            for (int i = 0; i < 3; ++i) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::E_avg, lev, patch,
+                                         *Efield_avg_cp[lev][i], ng);
+            }
         }
     }
 }
@@ -557,6 +634,9 @@ WarpX::FillBoundaryB_avg (int lev, IntVect ng, IntVect ng_extra_fine)
 void
 WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
 {
+    const int patch = static_cast<int>(patch_type);
+    if (!guard_cells.NeedsExchange(guardCellManager::FieldType::B_avg, lev, patch, ng)) return;
+
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -567,6 +647,10 @@ WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Bfield_avg_fp[lev][0].get(),Bfield_avg_fp[lev][1].get(),Bfield_avg_fp[lev][2].get()};
             amrex::FillBoundary(mf, period);
+            for (auto* pmf : mf) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::B_avg, lev, patch,
+                                         *pmf, pmf->nGrowVect());
+            }
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Bfield_fp[lev][0]->nGrowVect(),
@@ -574,6 +658,10 @@ WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
             Bfield_avg_fp[lev][0]->FillBoundary(ng, period);
             Bfield_avg_fp[lev][1]->FillBoundary(ng, period);
             Bfield_avg_fp[lev][2]->FillBoundary(ng, period);
+            for (int i = 0; i < 3; ++i) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::B_avg, lev, patch,
+                                         *Bfield_avg_fp[lev][i], ng);
+            }
         }
     }
     else if (patch_type == PatchType::coarse)
@@ -587,6 +675,10 @@ WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Bfield_avg_cp[lev][0].get(),Bfield_avg_cp[lev][1].get(),Bfield_avg_cp[lev][2].get()};
             amrex::FillBoundary(mf, cperiod);
+            for (auto* pmf : mf) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::B_avg, lev, patch,
+                                         *pmf, pmf->nGrowVect());
+            }
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Bfield_avg_cp[lev][0]->nGrowVect(),
@@ -594,6 +686,10 @@ WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
             Bfield_avg_cp[lev][0]->FillBoundary(ng, cperiod);
             Bfield_avg_cp[lev][1]->FillBoundary(ng, cperiod);
             Bfield_avg_cp[lev][2]->FillBoundary(ng, cperiod);
+            for (int i = 0; i < 3; ++i) {
+                guard_cells.SetExchanged(guardCellManager::FieldType::B_avg, lev, patch,
+                                         *Bfield_avg_cp[lev][i], ng);
+            }
         }
     }
 }
@@ -609,6 +705,9 @@ WarpX::FillBoundaryF (int lev, IntVect ng)
 void
 WarpX::FillBoundaryF (int lev, PatchType patch_type, IntVect ng)
 {
+    const int patch = static_cast<int>(patch_type);
+    if (!guard_cells.NeedsExchange(guardCellManager::FieldType::F, lev, patch, ng)) return;
+
     if (patch_type == PatchType::fine && F_fp[lev])
     {
         if (do_pml && pml[lev]->ok())
@@ -621,11 +720,14 @@ WarpX::FillBoundaryF (int lev, PatchType patch_type, IntVect ng)
         const auto& period = Geom(lev).periodicity();
         if ( safe_guard_cells ) {
             F_fp[lev]->FillBoundary(period);
+            guard_cells.SetExchanged(guardCellManager::FieldType::F, lev, patch,
+                                     *F_fp[lev], F_fp[lev]->nGrowVect());
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= F_fp[lev]->nGrowVect(),
                 "Error: in FillBoundaryF, requested more guard cells than allocated");
             F_fp[lev]->FillBoundary(ng, period);
+            guard_cells.SetExchanged(guardCellManager::FieldType::F, lev, patch, *F_fp[lev], ng);
         }
     }
     else if (patch_type == PatchType::coarse && F_cp[lev])
@@ -640,11 +742,14 @@ WarpX::FillBoundaryF (int lev, PatchType patch_type, IntVect ng)
         const auto& cperiod = Geom(lev-1).periodicity();
         if ( safe_guard_cells ) {
             F_cp[lev]->FillBoundary(cperiod);
+            guard_cells.SetExchanged(guardCellManager::FieldType::F, lev, patch,
+                                     *F_cp[lev], F_cp[lev]->nGrowVect());
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= F_cp[lev]->nGrowVect(),
                 "Error: in FillBoundaryF, requested more guard cells than allocated");
             F_cp[lev]->FillBoundary(ng, cperiod);
+            guard_cells.SetExchanged(guardCellManager::FieldType::F, lev, patch, *F_cp[lev], ng);
         }
     }
 }
@@ -757,11 +862,13 @@ WarpX::RestrictCurrentFromFineToCoarsePatch (int lev)
 void
 WarpX::ApplyFilterandSumBoundaryJ (int lev, PatchType patch_type)
 {
+    // With the spectral filter, J and rho are filtered by the PSATD solver
+    const bool use_realspace_filter = use_filter && !use_spectral_filter;
     const int glev = (patch_type == PatchType::fine) ? lev : lev-1;
     const auto& period = Geom(glev).periodicity();
     auto& j = (patch_type == PatchType::fine) ? current_fp[lev] : current_cp[lev];
     for (int idim = 0; idim < 3; ++idim) {
-        if (use_filter) {
+        if (use_realspace_filter) {
             IntVect ng = j[idim]->nGrowVect();
             ng += bilinear_filter.stencil_length_each_dir-1;
             MultiFab jf(j[idim]->boxArray(), j[idim]->DistributionMap(), j[idim]->nComp(), ng);
@@ -789,6 +896,8 @@ WarpX::ApplyFilterandSumBoundaryJ (int lev, PatchType patch_type)
 void
 WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
 {
+    // With the spectral filter, J and rho are filtered by the PSATD solver
+    const bool use_realspace_filter = use_filter && !use_spectral_filter;
     ApplyFilterandSumBoundaryJ(lev, PatchType::fine);
 
     if (lev < finest_level) {
@@ -800,7 +909,7 @@ WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
             MultiFab mf(current_fp[lev][idim]->boxArray(),
                         current_fp[lev][idim]->DistributionMap(), current_fp[lev][idim]->nComp(), 0);
             mf.setVal(0.0);
-            if (use_filter && current_buf[lev+1][idim])
+            if (use_realspace_filter && current_buf[lev+1][idim])
             {
                 // coarse patch of fine level
                 IntVect ng = current_cp[lev+1][idim]->nGrowVect();
@@ -819,7 +928,7 @@ WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
 
                 WarpXSumGuardCells(*current_cp[lev+1][idim], jfc, period, 0, current_cp[lev+1][idim]->nComp());
             }
-            else if (use_filter) // but no buffer
+            else if (use_realspace_filter) // but no buffer
             {
                 // coarse patch of fine level
                 IntVect ng = current_cp[lev+1][idim]->nGrowVect();
@@ -867,11 +976,13 @@ WarpX::RestrictRhoFromFineToCoarsePatch (int lev)
 void
 WarpX::ApplyFilterandSumBoundaryRho (int lev, PatchType patch_type, int icomp, int ncomp)
 {
+    // With the spectral filter, J and rho are filtered by the PSATD solver
+    const bool use_realspace_filter = use_filter && !use_spectral_filter;
     const int glev = (patch_type == PatchType::fine) ? lev : lev-1;
     const auto& period = Geom(glev).periodicity();
     auto& r = (patch_type == PatchType::fine) ? rho_fp[lev] : rho_cp[lev];
     if (r == nullptr) return;
-    if (use_filter) {
+    if (use_realspace_filter) {
         IntVect ng = r->nGrowVect();
         ng += bilinear_filter.stencil_length_each_dir-1;
         MultiFab rf(r->boxArray(), r->DistributionMap(), ncomp, ng);
@@ -898,6 +1009,8 @@ WarpX::ApplyFilterandSumBoundaryRho (int lev, PatchType patch_type, int icomp, i
 void
 WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
 {
+    // With the spectral filter, J and rho are filtered by the PSATD solver
+    const bool use_realspace_filter = use_filter && !use_spectral_filter;
     if (!rho_fp[lev]) return;
 
     ApplyFilterandSumBoundaryRho(lev, PatchType::fine, icomp, ncomp);
@@ -909,7 +1022,7 @@ WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
                     rho_fp[lev]->DistributionMap(),
                     ncomp, 0);
         mf.setVal(0.0);
-        if (use_filter && charge_buf[lev+1])
+        if (use_realspace_filter && charge_buf[lev+1])
         {
             // coarse patch of fine level
             IntVect ng = rho_cp[lev+1]->nGrowVect();
@@ -927,7 +1040,7 @@ WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
             mf.ParallelAdd(rhofb, 0, 0, ncomp, ng, IntVect::TheZeroVector(), period);
             WarpXSumGuardCells( *rho_cp[lev+1], rhofc, period, icomp, ncomp );
         }
-        else if (use_filter) // but no buffer
+        else if (use_realspace_filter) // but no buffer
         {
             IntVect ng = rho_cp[lev+1]->nGrowVect();
             ng += bilinear_filter.stencil_length_each_dir-1;
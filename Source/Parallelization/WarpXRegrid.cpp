@@ -98,6 +98,8 @@ WarpX::LoadBalance ()
 void
 WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const DistributionMapping& dm)
 {
+    guard_cells.SetAllStale();
+
     if (ba == boxArray(lev))
     {
         if (ParallelDescriptor::NProcs() == 1) return;
@@ -151,6 +153,23 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
             rho_fp[lev] = std::move(pmf);
         }
 
+        if (phi_fp[lev] != nullptr) {
+            const IntVect& ng = phi_fp[lev]->nGrowVect();
+            auto pmf = std::unique_ptr<MultiFab>(new MultiFab(phi_fp[lev]->boxArray(),
+                                                              dm, phi_fp[lev]->nComp(), ng));
+            // keep the potential, as initial guess for the next Poisson solve
+            pmf->Redistribute(*phi_fp[lev], 0, 0, phi_fp[lev]->nComp(), ng);
+            phi_fp[lev] = std::move(pmf);
+        }
+
+        if (rho_es_fp[lev] != nullptr) {
+            const IntVect& ng = rho_es_fp[lev]->nGrowVect();
+            auto pmf = std::unique_ptr<MultiFab>(new MultiFab(rho_es_fp[lev]->boxArray(),
+                                                              dm, rho_es_fp[lev]->nComp(), ng));
+            // no need to redistribute: charge is deposited again before each solve
+            rho_es_fp[lev] = std::move(pmf);
+        }
+
         // Aux patch
         if (lev == 0 && Bfield_aux[0][0]->ixType() == Bfield_fp[0][0]->ixType())
         {
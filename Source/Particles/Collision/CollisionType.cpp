@@ -7,8 +7,11 @@
 #include "CollisionType.H"
 #include "ShuffleFisherYates.H"
 #include "ElasticCollisionPerez.H"
+#include "Utils/WarpXRandom.H"
 #include <WarpX.H>
 
+#include <cstdint>
+
 CollisionType::CollisionType(
     const std::vector<std::string>& species_names,
     std::string const collision_name)
@@ -48,207 +51,242 @@ using namespace amrex;
 // Define shortcuts for frequently-used type names
 using ParticleType = WarpXParticleContainer::ParticleType;
 using ParticleTileType = WarpXParticleContainer::ParticleTileType;
-using ParticleBins = DenseBins<ParticleType>;
+using ParticleBins = WarpXParticleContainer::ParticleBins;
 using index_type = ParticleBins::index_type;
 
 namespace {
-
-    /* Find the particles and count the particles that are in each cell.
-       Note that this does *not* rearrange particle arrays */
-    ParticleBins
-    findParticlesInEachCell( int const lev, MFIter const& mfi,
-                             ParticleTileType const& ptile) {
-
-        // Extract particle structures for this tile
-        int const np = ptile.numParticles();
-        ParticleType const* particle_ptr = ptile.GetArrayOfStructs()().data();
-
-        // Extract box properties
-        Geometry const& geom = WarpX::GetInstance().Geom(lev);
-        Box const& cbx = mfi.tilebox(IntVect::TheZeroVector()); //Cell-centered box
-        const auto lo = lbound(cbx);
-        const auto dxi = geom.InvCellSizeArray();
-        const auto plo = geom.ProbLoArray();
-
-        // Find particles that are in each cell;
-        // results are stored in the object `bins`.
-        ParticleBins bins;
-        bins.build(np, particle_ptr, cbx,
-            // Pass lambda function that returns the cell index
-            [=] AMREX_GPU_HOST_DEVICE (const ParticleType& p) noexcept -> IntVect
-            {
-                return IntVect(AMREX_D_DECL(
-                                   static_cast<int>((p.pos(0)-plo[0])*dxi[0] - lo.x),
-                                   static_cast<int>((p.pos(1)-plo[1])*dxi[1] - lo.y),
-                                   static_cast<int>((p.pos(2)-plo[2])*dxi[2] - lo.z)));
-            });
-
-        return bins;
+    /** Find the two groups of particles that collide in the cell `i_cell`:
+     *  `indices_1[cell_start_1:cell_stop_1]` and `indices_2[cell_start_2:cell_stop_2]`.
+     *  For collisions within a species, these are the two halves of the particles
+     *  of the cell.
+     */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void getCollidingParticles (
+        int const i_cell, bool const isSameSpecies,
+        index_type const* cell_offsets_1, index_type const* cell_offsets_2,
+        index_type& cell_start_1, index_type& cell_stop_1,
+        index_type& cell_start_2, index_type& cell_stop_2 )
+    {
+        if ( isSameSpecies )
+        {
+            index_type const cell_half = (cell_offsets_1[i_cell]+cell_offsets_1[i_cell+1])/2;
+            cell_start_1 = cell_offsets_1[i_cell];
+            cell_stop_1  = cell_half;
+            cell_start_2 = cell_half;
+            cell_stop_2  = cell_offsets_1[i_cell+1];
+        }
+        else
+        {
+            cell_start_1 = cell_offsets_1[i_cell];
+            cell_stop_1  = cell_offsets_1[i_cell+1];
+            cell_start_2 = cell_offsets_2[i_cell];
+            cell_stop_2  = cell_offsets_2[i_cell+1];
+        }
     }
 
+    /** Index in the domain `domain` of the cell `i_cell` of the tile box `cbx`,
+     *  used to label the random streams of the cell. The cells are numbered
+     *  in the same order as the bins of amrex::DenseBins, i.e. with the
+     *  last direction varying fastest (unlike Box::atOffset).
+     */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    Long getCellIndexInDomain (int const i_cell, Box const& cbx, Box const& domain)
+    {
+        Dim3 const lo = amrex::lbound(cbx);
+        Dim3 const len = amrex::length(cbx);
+        int const k = i_cell % len.z;
+        int const j = (i_cell / len.z) % len.y;
+        int const i = i_cell / (len.z * len.y);
+        return domain.index(IntVect(AMREX_D_DECL(lo.x+i, lo.y+j, lo.z+k)));
+    }
 }
 
 /** Perform all binary collisions within a tile
+ *
+ * The collisions are done in two passes. The first pass loops over the cells:
+ * it shuffles the particles of each cell and computes the parameters of the
+ * collisions in this cell (densities and Debye length). The second pass loops
+ * over the slots of all the cells (see ElasticCollisionPerez), so that
+ * the pairs of a cell that contains many particles are not collided by a
+ * single thread. The random numbers are drawn from counter-based streams that
+ * only depend on the cell, the slot and the time step, and the particles of
+ * each cell are sorted by id before they are shuffled: the collisions do not
+ * depend on the order of the particles in the tile, nor on the number of threads.
  *
  * @param lev AMR level of the tile
  * @param mfi iterator for multifab
  * @param species1/2 pointer to species container
  * @param isSameSpecies true if collision is between same species
  * @param CoulombLog user input Coulomb logrithm
+ * @param collision_index index of the collision, for the random streams
  *
  */
 void CollisionType::doCoulombCollisionsWithinTile
     ( int const lev, MFIter const& mfi,
     std::unique_ptr<WarpXParticleContainer>& species_1,
     std::unique_ptr<WarpXParticleContainer>& species_2,
-    bool const isSameSpecies, Real const CoulombLog )
+    bool const isSameSpecies, Real const CoulombLog,
+    int const collision_index )
 {
-
-    if ( isSameSpecies ) // species_1 == species_2
-    {
-        // Extract particles in the tile that `mfi` points to
-        ParticleTileType& ptile_1 = species_1->ParticlesAt(lev, mfi);
-
-        // Find the particles that are in each cell of this tile
-        ParticleBins bins_1 = findParticlesInEachCell( lev, mfi, ptile_1 );
-
-        // Loop over cells, and collide the particles in each cell
-
-        // Extract low-level data
-        int const n_cells = bins_1.numBins();
-        // - Species 1
-        auto& soa_1 = ptile_1.GetStructOfArrays();
-        ParticleReal * const AMREX_RESTRICT ux_1 =
-            soa_1.GetRealData(PIdx::ux).data();
-        ParticleReal * const AMREX_RESTRICT uy_1 =
-            soa_1.GetRealData(PIdx::uy).data();
-        ParticleReal * const AMREX_RESTRICT uz_1  =
-            soa_1.GetRealData(PIdx::uz).data();
-        ParticleReal const * const AMREX_RESTRICT w_1 =
-            soa_1.GetRealData(PIdx::w).data();
-        index_type* indices_1 = bins_1.permutationPtr();
-        index_type const* cell_offsets_1 = bins_1.offsetsPtr();
-        Real q1 = species_1->getCharge();
-        Real m1 = species_1->getMass();
-
-        const Real dt = WarpX::GetInstance().getdt(lev);
-        Geometry const& geom = WarpX::GetInstance().Geom(lev);
+    // Extract particles in the tile that `mfi` points to
+    // (species_1 == species_2 for collisions within a species)
+    ParticleTileType& ptile_1 = species_1->ParticlesAt(lev, mfi);
+    ParticleTileType& ptile_2 = species_2->ParticlesAt(lev, mfi);
+
+    // Particles that are in each cell of this tile
+    ParticleBins& bins_1 = species_1->GetCellBins( lev, mfi );
+    ParticleBins& bins_2 = species_2->GetCellBins( lev, mfi );
+
+    // Extract low-level data
+    int const n_cells = bins_1.numBins();
+    // - Species 1
+    auto& soa_1 = ptile_1.GetStructOfArrays();
+    ParticleReal * const AMREX_RESTRICT ux_1 =
+        soa_1.GetRealData(PIdx::ux).data();
+    ParticleReal * const AMREX_RESTRICT uy_1 =
+        soa_1.GetRealData(PIdx::uy).data();
+    ParticleReal * const AMREX_RESTRICT uz_1 =
+        soa_1.GetRealData(PIdx::uz).data();
+    ParticleReal const * const AMREX_RESTRICT w_1 =
+        soa_1.GetRealData(PIdx::w).data();
+    index_type* indices_1 = bins_1.permutationPtr();
+    index_type const* cell_offsets_1 = bins_1.offsetsPtr();
+    ParticleType const* particles_1 = ptile_1.GetArrayOfStructs()().data();
+    Real q1 = species_1->getCharge();
+    Real m1 = species_1->getMass();
+    // - Species 2
+    auto& soa_2 = ptile_2.GetStructOfArrays();
+    Real* ux_2  = soa_2.GetRealData(PIdx::ux).data();
+    Real* uy_2  = soa_2.GetRealData(PIdx::uy).data();
+    Real* uz_2  = soa_2.GetRealData(PIdx::uz).data();
+    Real* w_2   = soa_2.GetRealData(PIdx::w).data();
+    index_type* indices_2 = bins_2.permutationPtr();
+    index_type const* cell_offsets_2 = bins_2.offsetsPtr();
+    ParticleType const* particles_2 = ptile_2.GetArrayOfStructs()().data();
+    Real q2 = species_2->getCharge();
+    Real m2 = species_2->getMass();
+
+    const Real dt = WarpX::GetInstance().getdt(lev);
+    Geometry const& geom = WarpX::GetInstance().Geom(lev);
 #if (AMREX_SPACEDIM == 2)
-        auto dV = geom.CellSize(0) * geom.CellSize(1);
+    auto dV = geom.CellSize(0) * geom.CellSize(1);
 #elif (AMREX_SPACEDIM == 3)
-        auto dV = geom.CellSize(0) * geom.CellSize(1) * geom.CellSize(2);
+    auto dV = geom.CellSize(0) * geom.CellSize(1) * geom.CellSize(2);
 #endif
 
-        // Loop over cells
-        amrex::ParallelFor( n_cells,
-            [=] AMREX_GPU_DEVICE (int i_cell) noexcept
+    // The random streams are labelled by the index of the cell in the domain
+    Box const cbx = mfi.tilebox(IntVect::TheZeroVector()); //Cell-centered box
+    Box const domain = geom.Domain();
+    std::uint32_t const step = WarpX::GetInstance().getistep(lev);
+    std::uint32_t const seed = WarpX::random_stream_seed;
+    std::uint32_t const shuffle_tag = RandomStreamTag::Instance(
+        RandomStreamTag::CollisionShuffle, collision_index );
+    std::uint32_t const scattering_tag = RandomStreamTag::Instance(
+        RandomStreamTag::CollisionScattering, collision_index );
+
+    // Parameters of the collisions in each cell, and number of slots of each cell
+    Gpu::DeviceVector<Real> n1_cell, n2_cell, n12_cell, lmdD_cell;
+    n1_cell.resize(n_cells);
+    n2_cell.resize(n_cells);
+    n12_cell.resize(n_cells);
+    lmdD_cell.resize(n_cells);
+    Gpu::DeviceVector<index_type> num_slots, slot_offsets;
+    num_slots.resize(n_cells+1);
+    slot_offsets.resize(n_cells+1);
+    Real* const AMREX_RESTRICT n1 = n1_cell.dataPtr();
+    Real* const AMREX_RESTRICT n2 = n2_cell.dataPtr();
+    Real* const AMREX_RESTRICT n12 = n12_cell.dataPtr();
+    Real* const AMREX_RESTRICT lmdD = lmdD_cell.dataPtr();
+    index_type* const AMREX_RESTRICT pnum_slots = num_slots.dataPtr();
+    index_type* const AMREX_RESTRICT pslot_offsets = slot_offsets.dataPtr();
+
+    // Loop over cells: shuffle the particles and compute the parameters
+    amrex::ParallelFor( n_cells+1,
+        [=] AMREX_GPU_DEVICE (int i_cell) noexcept
+        {
+            pnum_slots[i_cell] = 0;
+            if ( i_cell == n_cells ) return;
+
+            index_type cell_start_1, cell_stop_1, cell_start_2, cell_stop_2;
+            getCollidingParticles( i_cell, isSameSpecies,
+                                   cell_offsets_1, cell_offsets_2,
+                                   cell_start_1, cell_stop_1,
+                                   cell_start_2, cell_stop_2 );
+
+            // Do not collide if one of the two groups of particles is empty
+            // (e.g. only one particle in the cell, for the same species)
+            if ( cell_stop_1 - cell_start_1 >= 1 &&
+                 cell_stop_2 - cell_start_2 >= 1 )
             {
-                // The particles from species1 that are in the cell `i_cell` are
-                // given by the `indices_1[cell_start_1:cell_stop_1]`
-                index_type const cell_start_1 = cell_offsets_1[i_cell];
-                index_type const cell_stop_1  = cell_offsets_1[i_cell+1];
-                index_type const cell_half_1 = (cell_start_1+cell_stop_1)/2;
-
-                // Do not collide if there is only one particle in the cell
-                if ( cell_stop_1 - cell_start_1 >= 2 )
-                {
-                    // shuffle
-                    ShuffleFisherYates(
-                        indices_1, cell_start_1, cell_half_1 );
-
-                    // Call the function in order to perform collisions
-                    ElasticCollisionPerez(
-                        cell_start_1, cell_half_1,
-                        cell_half_1, cell_stop_1,
-                        indices_1, indices_1,
-                        ux_1, uy_1, uz_1, ux_1, uy_1, uz_1, w_1, w_1,
-                        q1, q1, m1, m1, Real(-1.0), Real(-1.0),
-                        dt, CoulombLog, dV );
+                RandomStream rng( getCellIndexInDomain(i_cell, cbx, domain), 0,
+                                  step, shuffle_tag, seed );
+
+                // sort by id, then shuffle
+                SortByParticleID( indices_1, cell_offsets_1[i_cell],
+                                  cell_offsets_1[i_cell+1], particles_1 );
+                if ( !isSameSpecies ) {
+                    SortByParticleID( indices_2, cell_start_2, cell_stop_2, particles_2 );
+                }
+                ShuffleFisherYates( indices_1, cell_start_1, cell_stop_1, rng );
+                if ( !isSameSpecies ) {
+                    ShuffleFisherYates( indices_2, cell_start_2, cell_stop_2, rng );
                 }
-            }
-        );
-    }
-    else // species_1 != species_2
-    {
-        // Extract particles in the tile that `mfi` points to
-        ParticleTileType& ptile_1 = species_1->ParticlesAt(lev, mfi);
-        ParticleTileType& ptile_2 = species_2->ParticlesAt(lev, mfi);
-
-        // Find the particles that are in each cell of this tile
-        ParticleBins bins_1 = findParticlesInEachCell( lev, mfi, ptile_1 );
-        ParticleBins bins_2 = findParticlesInEachCell( lev, mfi, ptile_2 );
-
-        // Loop over cells, and collide the particles in each cell
-
-        // Extract low-level data
-        int const n_cells = bins_1.numBins();
-        // - Species 1
-        auto& soa_1 = ptile_1.GetStructOfArrays();
-        ParticleReal * const AMREX_RESTRICT ux_1 =
-            soa_1.GetRealData(PIdx::ux).data();
-        ParticleReal * const AMREX_RESTRICT uy_1 =
-            soa_1.GetRealData(PIdx::uy).data();
-        ParticleReal * const AMREX_RESTRICT uz_1 =
-            soa_1.GetRealData(PIdx::uz).data();
-        ParticleReal const * const AMREX_RESTRICT w_1 =
-            soa_1.GetRealData(PIdx::w).data();
-        index_type* indices_1 = bins_1.permutationPtr();
-        index_type const* cell_offsets_1 = bins_1.offsetsPtr();
-        Real q1 = species_1->getCharge();
-        Real m1 = species_1->getMass();
-        // - Species 2
-        auto& soa_2 = ptile_2.GetStructOfArrays();
-        Real* ux_2  = soa_2.GetRealData(PIdx::ux).data();
-        Real* uy_2  = soa_2.GetRealData(PIdx::uy).data();
-        Real* uz_2  = soa_2.GetRealData(PIdx::uz).data();
-        Real* w_2   = soa_2.GetRealData(PIdx::w).data();
-        index_type* indices_2 = bins_2.permutationPtr();
-        index_type const* cell_offsets_2 = bins_2.offsetsPtr();
-        Real q2 = species_2->getCharge();
-        Real m2 = species_2->getMass();
-
-        const Real dt = WarpX::GetInstance().getdt(lev);
-        Geometry const& geom = WarpX::GetInstance().Geom(lev);
-#if (AMREX_SPACEDIM == 2)
-        auto dV = geom.CellSize(0) * geom.CellSize(1);
-#elif (AMREX_SPACEDIM == 3)
-        auto dV = geom.CellSize(0) * geom.CellSize(1) * geom.CellSize(2);
-#endif
 
-        // Loop over cells
-        amrex::ParallelFor( n_cells,
-            [=] AMREX_GPU_DEVICE (int i_cell) noexcept
-            {
-                // The particles from species1 that are in the cell `i_cell` are
-                // given by the `indices_1[cell_start_1:cell_stop_1]`
-                index_type const cell_start_1 = cell_offsets_1[i_cell];
-                index_type const cell_stop_1  = cell_offsets_1[i_cell+1];
-                // Same for species 2
-                index_type const cell_start_2 = cell_offsets_2[i_cell];
-                index_type const cell_stop_2  = cell_offsets_2[i_cell+1];
-
-                // ux from species1 can be accessed like this:
-                // ux_1[ indices_1[i] ], where i is between
-                // cell_start_1 (inclusive) and cell_start_2 (exclusive)
-
-                // Do not collide if one species is missing in the cell
-                if ( cell_stop_1 - cell_start_1 >= 1 &&
-                     cell_stop_2 - cell_start_2 >= 1 )
-                {
-                    // shuffle
-                    ShuffleFisherYates(indices_1, cell_start_1, cell_stop_1);
-                    ShuffleFisherYates(indices_2, cell_start_2, cell_stop_2);
-
-                    // Call the function in order to perform collisions
-                    ElasticCollisionPerez(
-                        cell_start_1, cell_stop_1, cell_start_2, cell_stop_2,
-                        indices_1, indices_2,
-                        ux_1, uy_1, uz_1, ux_2, uy_2, uz_2, w_1, w_2,
-                        q1, q2, m1, m2, Real(-1.0), Real(-1.0),
-                        dt, CoulombLog, dV );
+                ElasticCollisionPerezCellParameters(
+                    cell_start_1, cell_stop_1, cell_start_2, cell_stop_2,
+                    indices_1, indices_2,
+                    ux_1, uy_1, uz_1, ux_2, uy_2, uz_2, w_1, w_2,
+                    q1, q2, m1, m2, Real(-1.0), Real(-1.0),
+                    CoulombLog, dV,
+                    n1[i_cell], n2[i_cell], n12[i_cell], lmdD[i_cell] );
+
+                pnum_slots[i_cell] = amrex::min( cell_stop_1 - cell_start_1,
+                                                 cell_stop_2 - cell_start_2 );
+            }
+        }
+    );
+    Gpu::exclusive_scan(num_slots.begin(), num_slots.end(), slot_offsets.begin());
+    index_type n_slots;
+    Gpu::dtoh_memcpy(&n_slots, pslot_offsets+n_cells, sizeof(index_type));
+
+    // Loop over the slots of all the cells, and collide their pairs
+    amrex::ParallelFor( static_cast<int>(n_slots),
+        [=] AMREX_GPU_DEVICE (int i_slot) noexcept
+        {
+            // Find the cell of the slot, such that
+            // pslot_offsets[i_cell] <= i_slot < pslot_offsets[i_cell+1]
+            int i_cell = 0;
+            int i_cell_end = n_cells;
+            while ( i_cell_end - i_cell > 1 ) {
+                int const mid = (i_cell + i_cell_end)/2;
+                if ( pslot_offsets[mid] <= static_cast<index_type>(i_slot) ) {
+                    i_cell = mid;
+                } else {
+                    i_cell_end = mid;
                 }
             }
-        );
-    } // end if ( isSameSpecies)
+
+            index_type cell_start_1, cell_stop_1, cell_start_2, cell_stop_2;
+            getCollidingParticles( i_cell, isSameSpecies,
+                                   cell_offsets_1, cell_offsets_2,
+                                   cell_start_1, cell_stop_1,
+                                   cell_start_2, cell_stop_2 );
+
+            int const islot = i_slot - pslot_offsets[i_cell];
+            RandomStream rng( getCellIndexInDomain(i_cell, cbx, domain), islot+1,
+                              step, scattering_tag, seed );
+
+            // Call the function in order to perform collisions
+            ElasticCollisionPerez(
+                islot, cell_start_1, cell_stop_1, cell_start_2, cell_stop_2,
+                indices_1, indices_2,
+                ux_1, uy_1, uz_1, ux_2, uy_2, uz_2, w_1, w_2,
+                q1, q2, m1, m2, n1[i_cell], n2[i_cell], n12[i_cell],
+                dt, CoulombLog, lmdD[i_cell], rng );
+        }
+    );
+    // Make sure that the temporary arrays are not destroyed before
+    // the GPU kernels finish running
+    Gpu::streamSynchronize();
 
 }
@@ -69,4 +69,7 @@ IonizationFilterFunc::IonizationFilterFunc (const WarpXParIter& a_pti, int lev,
     m_n_rz_azimuthal_modes = WarpX::n_rz_azimuthal_modes;
 
     m_lo = amrex::lbound(box);
+
+    m_step = WarpX::GetInstance().getistep(std::max(lev, 0));
+    m_random_seed = WarpX::random_stream_seed;
 }
@@ -11,6 +11,7 @@
 
 PairGenerationTransformFunc::
 PairGenerationTransformFunc (BreitWheelerGeneratePairs const generate_functor,
+                             int const species_id,
                              const WarpXParIter& a_pti, int lev, int ngE,
                              amrex::FArrayBox const& exfab,
                              amrex::FArrayBox const& eyfab,
@@ -22,6 +23,10 @@ PairGenerationTransformFunc (BreitWheelerGeneratePairs const generate_functor,
                              int a_offset)
 : m_generate_functor(generate_functor)
 {
+    m_step = WarpX::GetInstance().getistep(std::max(lev, 0));
+    m_random_seed = WarpX::random_stream_seed;
+    m_random_tag = RandomStreamTag::Instance(RandomStreamTag::QedEvent, species_id);
+
     m_get_position  = GetParticlePosition(a_pti, a_offset);
     m_get_externalE = GetExternalEField  (a_pti, a_offset);
     m_get_externalB = GetExternalBField  (a_pti, a_offset);
@@ -12,6 +12,7 @@
 PhotonEmissionTransformFunc::
 PhotonEmissionTransformFunc (QuantumSynchrotronGetOpticalDepth opt_depth_functor,
                              int const opt_depth_runtime_comp,
+                             int const species_id,
                              QuantumSynchrotronGeneratePhotonAndUpdateMomentum const emission_functor,
                              const WarpXParIter& a_pti, int lev, int ngE,
                              amrex::FArrayBox const& exfab,
@@ -26,6 +27,10 @@ PhotonEmissionTransformFunc (QuantumSynchrotronGetOpticalDepth opt_depth_functor
  m_opt_depth_runtime_comp{opt_depth_runtime_comp},
  m_emission_functor{emission_functor}
 {
+    m_step = WarpX::GetInstance().getistep(std::max(lev, 0));
+    m_random_seed = WarpX::random_stream_seed;
+    m_random_tag = RandomStreamTag::Instance(RandomStreamTag::QedEvent, species_id);
+
     m_get_position  = GetParticlePosition(a_pti, a_offset);
     m_get_externalE = GetExternalEField  (a_pti, a_offset);
     m_get_externalB = GetExternalBField  (a_pti, a_offset);
@@ -0,0 +1,197 @@
+/* Copyright 2020 The WarpX Community
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "MergingUtils.H"
+#include "Particles/PhysicalParticleContainer.H"
+#include "Particles/Sorting/SortingUtils.H"
+#include "WarpX.H"
+
+#include <AMReX_Particles.H>
+
+#include <limits>
+#include <utility>
+
+
+using namespace amrex;
+
+/* \brief Merge the particles of the cells that contain more than
+ * merging_max_ppc particles, so that they contain about merging_target_ppc
+ * particles.
+ *
+ * In each such cell, the particles are sorted by momentum-space bin (see
+ * getMomentumBin), and the particles of each bin are split in groups of
+ * consecutive particles. Each group of at least 3 particles is replaced by
+ * 2 particles with the same total weight, momentum and energy (see
+ * MergeParticleGroup). The removed particles are then compacted out of the
+ * tile, with the same component-by-component reordering as the sorting.
+ *
+ * Each momentum-space bin that contains particles keeps at least 2 of them,
+ * so that a cell keeps at most merging_target_ppc particles plus 2 particles
+ * per momentum-space bin.
+ *
+ * \param step time step, checked against merging_intervals
+ */
+void
+PhysicalParticleContainer::MergeParticles (int step)
+{
+    if (!do_merging || !m_merging_intervals.contains(step)) return;
+
+    WARPX_PROFILE("PPC::MergeParticles()");
+
+    // The merged particles moved: the fields stored at the positions of the
+    // particles by the ionization filter must not be used by the next push
+    ClearIonizationGather();
+
+    using index_type = ParticleBins::index_type;
+
+    int const max_ppc = m_merging_max_ppc;
+    int const target_ppc = m_merging_target_ppc;
+    int const n_bins = m_merging_momentum_bins;
+    bool const is_massive = (mass > 0.);
+
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        BuildCellBins(lev);
+
+        MFItInfo info;
+        if (Gpu::notInLaunchRegion()) info.EnableTiling(tile_size);
+#ifdef _OPENMP
+        info.SetDynamic(true);
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi = MakeMFIter(lev, info); mfi.isValid(); ++mfi)
+        {
+            auto& ptile = ParticlesAt(lev, mfi);
+            const long np = ptile.numParticles();
+            if (np <= max_ppc) continue;
+
+            ParticleBins& bins = GetCellBins(lev, mfi);
+            int const n_cells = bins.numBins();
+            index_type* const indices = bins.permutationPtr();
+            index_type const* const cell_offsets = bins.offsetsPtr();
+
+            auto& aos = ptile.GetArrayOfStructs();
+            auto& soa = ptile.GetStructOfArrays();
+            ParticleType* const particles = aos().dataPtr();
+            ParticleReal* const w  = soa.GetRealData(PIdx::w).dataPtr();
+            ParticleReal* const ux = soa.GetRealData(PIdx::ux).dataPtr();
+            ParticleReal* const uy = soa.GetRealData(PIdx::uy).dataPtr();
+            ParticleReal* const uz = soa.GetRealData(PIdx::uz).dataPtr();
+
+            Gpu::DeviceVector<int> momentum_bin(np);
+            Gpu::DeviceVector<int> keep(np);
+            int* const AMREX_RESTRICT pbin = momentum_bin.dataPtr();
+            int* const AMREX_RESTRICT pkeep = keep.dataPtr();
+            amrex::ParallelFor( np,
+                [=] AMREX_GPU_DEVICE (long i) noexcept { pkeep[i] = 1; });
+
+            // Merge the particles of each cell
+            amrex::ParallelFor( n_cells,
+                [=] AMREX_GPU_DEVICE (int i_cell) noexcept
+                {
+                    index_type const cell_start = cell_offsets[i_cell];
+                    int const n = cell_offsets[i_cell+1] - cell_start;
+                    if (n <= max_ppc) return;
+                    index_type* const cell_indices = indices + cell_start;
+
+                    // Extrema of the norm of the momenta in this cell
+                    Real u_min = std::numeric_limits<Real>::max();
+                    Real u_max = 0.;
+                    for (int k = 0; k < n; ++k) {
+                        index_type const i = cell_indices[k];
+                        Real const u = std::sqrt(ux[i]*ux[i] + uy[i]*uy[i] + uz[i]*uz[i]);
+                        u_min = amrex::min(u_min, u);
+                        u_max = amrex::max(u_max, u);
+                    }
+                    for (int k = 0; k < n; ++k) {
+                        index_type const i = cell_indices[k];
+                        pbin[i] = getMomentumBin(ux[i], uy[i], uz[i], u_min, u_max, n_bins);
+                    }
+                    HeapSortByKey(cell_indices, n, pbin);
+
+                    // Groups of group_size particles become 2 particles
+                    int const group_size = amrex::max(3, (2*n + target_ppc - 1)/target_ppc);
+                    int run_start = 0;
+                    while (run_start < n)
+                    {
+                        int run_stop = run_start + 1;
+                        while (run_stop < n &&
+                               pbin[cell_indices[run_stop]] == pbin[cell_indices[run_start]]) {
+                            ++run_stop;
+                        }
+                        int const n_run = run_stop - run_start;
+                        int const n_groups = amrex::max(1, n_run/group_size);
+                        for (int j = 0; j < n_groups; ++j)
+                        {
+                            int const group_start = run_start + (n_run*j)/n_groups;
+                            int const group_stop = run_start + (n_run*(j+1))/n_groups;
+                            if (group_stop - group_start < 3) continue;
+                            MergeParticleGroup(cell_indices + group_start,
+                                               group_stop - group_start,
+                                               particles, w, ux, uy, uz, pkeep,
+                                               is_massive);
+                        }
+                        run_start = run_stop;
+                    }
+                });
+
+            // Find the indices of the particles that are kept
+            Gpu::DeviceVector<int> offsets(np);
+            Gpu::exclusive_scan(keep.begin(), keep.end(), offsets.begin());
+            int last_keep, last_offset;
+            Gpu::copyAsync(Gpu::deviceToHost, keep.dataPtr()+np-1, keep.dataPtr()+np, &last_keep);
+            Gpu::copyAsync(Gpu::deviceToHost, offsets.dataPtr()+np-1, offsets.dataPtr()+np, &last_offset);
+            Gpu::streamSynchronize();
+            const long np_kept = last_keep + last_offset;
+            if (np_kept == np) continue;
+
+            Gpu::DeviceVector<long> pid(np_kept);
+            long* const AMREX_RESTRICT ppid = pid.dataPtr();
+            int const* const AMREX_RESTRICT poffsets = offsets.dataPtr();
+            amrex::ParallelFor( np,
+                [=] AMREX_GPU_DEVICE (long i) noexcept
+                {
+                    if (pkeep[i]) ppid[poffsets[i]] = i;
+                });
+
+            // Remove the other particles from the AoS and from each attribute
+            {
+                ParticleVector particle_tmp;
+                particle_tmp.resize(np_kept);
+                amrex::ParallelFor( np_kept,
+                    copyAndReorder<ParticleType>( aos(), particle_tmp, pid ) );
+                std::swap(aos(), particle_tmp);
+                Gpu::streamSynchronize();
+            }
+            {
+                RealVector tmp;
+                for (int comp = 0; comp < NumRealComps(); ++comp) {
+                    auto& attrib = soa.GetRealData(comp);
+                    tmp.resize(np_kept);
+                    amrex::ParallelFor( np_kept,
+                        copyAndReorder<ParticleReal>( attrib, tmp, pid ) );
+                    std::swap(attrib, tmp);
+                }
+                Gpu::streamSynchronize();
+            }
+            if (NumIntComps() > 0)
+            {
+                IntVector tmp;
+                for (int comp = 0; comp < NumIntComps(); ++comp) {
+                    auto& attrib = soa.GetIntData(comp);
+                    tmp.resize(np_kept);
+                    amrex::ParallelFor( np_kept,
+                        copyAndReorder<int>( attrib, tmp, pid ) );
+                    std::swap(attrib, tmp);
+                }
+                Gpu::streamSynchronize();
+            }
+        }
+    }
+
+    // The cell bins refer to the removed particles
+    InvalidateCellBins();
+}
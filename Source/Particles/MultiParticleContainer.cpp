@@ -372,6 +372,44 @@ MultiParticleContainer::GetChargeDensity (int lev, bool local)
     return rho;
 }
 
+std::unique_ptr<MultiFab>
+MultiParticleContainer::GetChargeDensity (int lev, const Box& region, bool local)
+{
+    std::unique_ptr<MultiFab> rho = allcontainers[0]->GetChargeDensity(lev, region, true);
+    for (unsigned i = 1, n = allcontainers.size(); i < n; ++i) {
+        std::unique_ptr<MultiFab> rhoi = allcontainers[i]->GetChargeDensity(lev, region, true);
+        MultiFab::Add(*rho, *rhoi, 0, 0, rho->nComp(), rho->nGrow());
+    }
+    if (!local) {
+        const Geometry& gm = allcontainers[0]->Geom(lev);
+        rho->SumBoundary(gm.periodicity());
+    }
+    return rho;
+}
+
+void
+MultiParticleContainer::DepositCharge (amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho)
+{
+    // All species accumulate into the same array: only the first one resets it,
+    // and only the last one exchanges guard cells and averages down the levels,
+    // so that these operations are done once for the total charge density.
+    if (nspecies == 0) {
+        for (auto& rho_lev : rho) rho_lev->setVal(0.0, rho_lev->nGrow());
+        return;
+    }
+    for (int ispecies = 0; ispecies < nspecies; ++ispecies) {
+        bool const first = (ispecies == 0);
+        bool const last = (ispecies == nspecies-1);
+        bool const local = !last;
+        bool const reset = first;
+        bool const do_rz_volume_scaling = last;
+        bool const interpolate_across_levels = last;
+        allcontainers[ispecies]->DepositCharge(rho, local, reset,
+                                               do_rz_volume_scaling,
+                                               interpolate_across_levels);
+    }
+}
+
 void
 MultiParticleContainer::SortParticlesByBin (amrex::IntVect bin_size)
 {
@@ -380,6 +418,29 @@ MultiParticleContainer::SortParticlesByBin (amrex::IntVect bin_size)
     }
 }
 
+void
+MultiParticleContainer::MergeParticles (int step)
+{
+    for (auto& pc : allcontainers) {
+        if (!pc->do_merging) continue;
+        static_cast<PhysicalParticleContainer*>(pc.get())->MergeParticles(step);
+    }
+}
+
+amrex::Real
+MultiParticleContainer::SortLocality (amrex::IntVect bin_size)
+{
+    long num_same_bin = 0;
+    long num_particles = 0;
+    for (auto& pc : allcontainers) {
+        pc->CountParticlesInSameBin(bin_size, num_same_bin, num_particles);
+    }
+    ParallelDescriptor::ReduceLongSum(num_same_bin);
+    ParallelDescriptor::ReduceLongSum(num_particles);
+    if (num_particles == 0) return 1.;
+    return static_cast<amrex::Real>(num_same_bin)/num_particles;
+}
+
 void
 MultiParticleContainer::Redistribute ()
 {
@@ -646,7 +707,8 @@ MultiParticleContainer::doFieldIonization (int lev,
         SmartCopyFactory copy_factory(*pc_source, *pc_product);
         auto phys_pc_ptr = static_cast<PhysicalParticleContainer*>(pc_source.get());
 
-        auto Copy      = copy_factory.getSmartCopy();
+        auto Copy      = copy_factory.getSmartCopy(
+            WarpX::GetInstance().getistep(lev), WarpX::random_stream_seed);
         auto Transform = IonizationTransformFunc();
 
         pc_source ->defineAllParticleTiles();
@@ -654,11 +716,16 @@ MultiParticleContainer::doFieldIonization (int lev,
 
         auto info = getMFItInfo(*pc_source, *pc_product);
 
+        NewParticleIDs<WarpXParticleContainer::ParticleTileType> new_ids;
+
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
         for (WarpXParIter pti(*pc_source, lev, info); pti.isValid(); ++pti)
         {
+            // Tiles without source particles create no particles
+            if (pti.numParticles() == 0) continue;
+
             auto& src_tile = pc_source ->ParticlesAt(lev, pti);
             auto& dst_tile = pc_product->ParticlesAt(lev, pti);
 
@@ -667,11 +734,25 @@ MultiParticleContainer::doFieldIonization (int lev,
                                                          Bx[pti], By[pti], Bz[pti]);
 
             const auto np_dst = dst_tile.numParticles();
-            const auto num_added = filterCopyTransformParticles<1>(dst_tile, src_tile, np_dst,
-                                                                   Filter, Copy, Transform);
+            const auto num_added =
+                filterCopyTransformParticles<1>(dst_tile, src_tile, np_dst,
+                                                Filter, Copy, Transform);
 
-            setNewParticleIDs(dst_tile, np_dst, num_added);
+            new_ids.record(lev, pti.index(), pti.LocalTileIndex(),
+                           dst_tile, np_dst, num_added);
         }
+
+        new_ids.assign();
+    }
+}
+
+void
+MultiParticleContainer::ClearIonizationGather ()
+{
+    for (auto& pc : allcontainers)
+    {
+        if (!pc->do_field_ionization){ continue; }
+        static_cast<PhysicalParticleContainer*>(pc.get())->ClearIonizationGather();
     }
 }
 
@@ -692,6 +773,11 @@ MultiParticleContainer::doCoulombCollisions ()
         // Loop over refinement levels
         for (int lev = 0; lev <= species1->finestLevel(); ++lev){
 
+            // Bin the particles by cell (done once for all the
+            // collisions involving the same species)
+            species1->BuildCellBins(lev);
+            species2->BuildCellBins(lev);
+
             // Loop over all grids/tiles at this level
 #ifdef _OPENMP
             info.SetDynamic(true);
@@ -702,11 +788,18 @@ MultiParticleContainer::doCoulombCollisions ()
                 CollisionType::doCoulombCollisionsWithinTile
                     ( lev, mfi, species1, species2,
                       allcollisions[i]->m_isSameSpecies,
-                      allcollisions[i]->m_CoulombLog );
+                      allcollisions[i]->m_CoulombLog, i );
 
             }
         }
     }
+
+    // The particles move before the next collisions
+    for (int i = 0; i < ncollisions; ++i)
+    {
+        allcontainers[ allcollisions[i]->m_species1_index ]->InvalidateCellBins();
+        allcontainers[ allcollisions[i]->m_species2_index ]->InvalidateCellBins();
+    }
 }
 
 void MultiParticleContainer::CheckIonizationProductSpecies()
@@ -1165,8 +1258,10 @@ void MultiParticleContainer::doQedBreitWheeler (int lev,
         auto phys_pc_ptr = static_cast<PhysicalParticleContainer*>(pc_source.get());
 
         const auto Filter  = phys_pc_ptr->getPairGenerationFilterFunc();
-        const auto CopyEle = copy_factory_ele.getSmartCopy();
-        const auto CopyPos = copy_factory_pos.getSmartCopy();
+        const auto CopyEle = copy_factory_ele.getSmartCopy(
+            WarpX::GetInstance().getistep(lev), WarpX::random_stream_seed);
+        const auto CopyPos = copy_factory_pos.getSmartCopy(
+            WarpX::GetInstance().getistep(lev), WarpX::random_stream_seed);
 
         const auto pair_gen_functor = m_shr_p_bw_engine->build_pair_functor();
 
@@ -1176,12 +1271,18 @@ void MultiParticleContainer::doQedBreitWheeler (int lev,
 
         auto info = getMFItInfo(*pc_source, *pc_product_ele, *pc_product_pos);
 
+        NewParticleIDs<WarpXParticleContainer::ParticleTileType> new_ids;
+
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
         for (WarpXParIter pti(*pc_source, lev, info); pti.isValid(); ++pti)
         {
+            // Tiles without source particles create no particles
+            if (pti.numParticles() == 0) continue;
+
             auto Transform = PairGenerationTransformFunc(pair_gen_functor,
+                                                         pc_source->getSpeciesId(),
                                                          pti, lev, Ex.nGrow(),
                                                          Ex[pti], Ey[pti], Ez[pti],
                                                          Bx[pti], By[pti], Bz[pti],
@@ -1193,14 +1294,18 @@ void MultiParticleContainer::doQedBreitWheeler (int lev,
 
             const auto np_dst_ele = dst_ele_tile.numParticles();
             const auto np_dst_pos = dst_pos_tile.numParticles();
-            const auto num_added = filterCopyTransformParticles<1>(
-                                                      dst_ele_tile, dst_pos_tile,
-                                                      src_tile, np_dst_ele, np_dst_pos,
-                                                      Filter, CopyEle, CopyPos, Transform);
-
-            setNewParticleIDs(dst_ele_tile, np_dst_ele, num_added);
-            setNewParticleIDs(dst_pos_tile, np_dst_pos, num_added);
+            const auto num_added =
+                filterCopyTransformParticles<1>(dst_ele_tile, dst_pos_tile,
+                                                src_tile, np_dst_ele, np_dst_pos,
+                                                Filter, CopyEle, CopyPos, Transform);
+
+            new_ids.record(lev, pti.index(), pti.LocalTileIndex(),
+                           dst_ele_tile, np_dst_ele, num_added);
+            new_ids.record(lev, pti.index(), pti.LocalTileIndex(),
+                           dst_pos_tile, np_dst_pos, num_added);
         }
+
+        new_ids.assign();
     }
 }
 
@@ -1230,21 +1335,28 @@ void MultiParticleContainer::doQedQuantumSync (int lev,
             static_cast<PhysicalParticleContainer*>(pc_source.get());
 
         const auto Filter   = phys_pc_ptr->getPhotonEmissionFilterFunc();
-        const auto CopyPhot = copy_factory_phot.getSmartCopy();
+        const auto CopyPhot = copy_factory_phot.getSmartCopy(
+            WarpX::GetInstance().getistep(lev), WarpX::random_stream_seed);
 
         pc_source ->defineAllParticleTiles();
         pc_product_phot->defineAllParticleTiles();
 
         auto info = getMFItInfo(*pc_source, *pc_product_phot);
 
+        NewParticleIDs<WarpXParticleContainer::ParticleTileType> new_ids;
+
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
         for (WarpXParIter pti(*pc_source, lev, info); pti.isValid(); ++pti)
         {
+            // Tiles without source particles create no particles
+            if (pti.numParticles() == 0) continue;
+
             auto Transform = PhotonEmissionTransformFunc(
                   m_shr_p_qs_engine->build_optical_depth_functor(),
                   pc_source->particle_runtime_comps["optical_depth_QSR"],
+                  pc_source->getSpeciesId(),
                   m_shr_p_qs_engine->build_phot_em_functor(),
                   pti, lev, Ex.nGrow(),
                   Ex[pti], Ey[pti], Ez[pti],
@@ -1260,12 +1372,17 @@ void MultiParticleContainer::doQedQuantumSync (int lev,
                 filterCopyTransformParticles<1>(dst_tile, src_tile, np_dst,
                                                 Filter, CopyPhot, Transform);
 
-            setNewParticleIDs(dst_tile, np_dst, num_added);
+            if (num_added > 0) {
+                cleanLowEnergyPhotons(
+                                      dst_tile, np_dst, num_added,
+                                      m_quantum_sync_photon_creation_energy_threshold);
+            }
 
-            cleanLowEnergyPhotons(
-                                  dst_tile, np_dst, num_added,
-                                  m_quantum_sync_photon_creation_energy_threshold);
+            new_ids.record(lev, pti.index(), pti.LocalTileIndex(),
+                           dst_tile, np_dst, num_added);
         }
+
+        new_ids.assign();
     }
 }
 
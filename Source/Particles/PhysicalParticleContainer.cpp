@@ -22,6 +22,7 @@
 #include "Particles/Pusher/PushSelector.H"
 #include "Particles/Gather/GetExternalFields.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/WarpXRandom.H"
 
 #include <AMReX_Print.H>
 
@@ -121,6 +122,28 @@ PhysicalParticleContainer::PhysicalParticleContainer (AmrCore* amr_core, int isp
 
     pp.query("do_field_ionization", do_field_ionization);
 
+    // Initialize merging
+    pp.query("do_merging", do_merging);
+    if (do_merging) {
+#ifdef WARPX_DIM_RZ
+        amrex::Abort("Particle merging only works in Cartesian geometry for now.");
+#endif
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!do_field_ionization,
+            "ERROR: particle merging is not supported for ionizable species");
+        std::string merging_int_string = "1";
+        pp.query("merging_intervals", merging_int_string);
+        m_merging_intervals = IntervalsParser(merging_int_string);
+        pp.get("merging_max_ppc", m_merging_max_ppc);
+        m_merging_target_ppc = m_merging_max_ppc/2;
+        pp.query("merging_target_ppc", m_merging_target_ppc);
+        pp.query("merging_momentum_bins", m_merging_momentum_bins);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            m_merging_target_ppc >= 2 && m_merging_target_ppc <= m_merging_max_ppc,
+            "ERROR: " + species_name + ".merging_target_ppc must be between 2 and merging_max_ppc");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_merging_momentum_bins > 0,
+            "ERROR: " + species_name + ".merging_momentum_bins must be positive");
+    }
+
     //check if Radiation Reaction is enabled and do consistency checks
     pp.query("do_classical_radiation_reaction", do_classical_radiation_reaction);
     //if the species is not a lepton, do_classical_radiation_reaction
@@ -305,7 +328,10 @@ PhysicalParticleContainer::AddGaussianBeam (
                 std::abs( x - x_m ) < x_cut * x_rms     &&
                 std::abs( y - y_m ) < y_cut * y_rms     &&
                 std::abs( z - z_m ) < z_cut * z_rms   ) {
-                XDim3 u = plasma_injector->getMomentum(x, y, z);
+                RandomStream rng(i, 0, 0,
+                                 RandomStreamTag::Instance(RandomStreamTag::BeamInjection, species_id),
+                                 WarpX::random_stream_seed);
+                XDim3 u = plasma_injector->getMomentum(x, y, z, rng);
                 u.x *= PhysConst::c;
                 u.y *= PhysConst::c;
                 u.z *= PhysConst::c;
@@ -578,6 +604,9 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
     if (do_tiling && Gpu::notInLaunchRegion()) {
         info.EnableTiling(tile_size);
     }
+
+    NewParticleIDs<ParticleTileType> new_ids;
+
 #ifdef _OPENMP
     info.SetDynamic(true);
 #pragma omp parallel if (not WarpX::serialize_ics)
@@ -676,18 +705,6 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
         std::memcpy(&max_new_particles, offset.dataPtr()+overlap_box.numPts(), sizeof(int));
 #endif
 
-        // Update NextID to include particles created in this function
-        int pid;
-#ifdef _OPENMP
-#pragma omp critical (add_plasma_nextid)
-#endif
-        {
-            pid = ParticleType::NextID();
-            ParticleType::NextID(pid+max_new_particles);
-        }
-        WarpXUtilMsg::AlwaysAssert(static_cast<int>(pid + max_new_particles) > 0,
-                                   "ERROR: overflow on particle id numbers");
-
         const int cpuid = ParallelDescriptor::MyProc();
 
         auto& particle_tile = GetParticles(lev)[std::make_pair(grid_id,tile_id)];
@@ -744,6 +761,14 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
         bool loc_do_field_ionization = do_field_ionization;
         int loc_ionization_initial_level = ionization_initial_level;
 
+        // The random streams of the new particles are labelled by the index
+        // of their cell in the domain and their index within the cell
+        const Box domain_box = geom.Domain();
+        const std::uint32_t random_step = WarpX::GetInstance().getistep(lev);
+        const std::uint32_t random_seed = WarpX::random_stream_seed;
+        const std::uint32_t random_tag = RandomStreamTag::Instance(
+            RandomStreamTag::PlasmaInjection, species_id);
+
         // Loop over all new particles and inject them (creates too many
         // particles, in particular does not consider xmin, xmax etc.).
         // The invalid ones are given negative ID and are deleted during the
@@ -757,11 +782,15 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
             {
                 long ip = poffset[index] + i_part;
                 ParticleType& p = pp[ip];
-                p.id() = pid+ip;
+                // Temporary id, see NewParticleIDs
+                p.id() = ip;
                 p.cpu() = cpuid;
 
+                RandomStream rng(domain_box.index(iv + shifted), i_part,
+                                 random_step, random_tag, random_seed);
+
                 const XDim3 r =
-                    inj_pos->getPositionUnitBox(i_part, lrrfac);
+                    inj_pos->getPositionUnitBox(i_part, lrrfac, rng);
                 auto pos = getCellCoords(overlap_corner, dx, r, iv);
 
 #if (AMREX_SPACEDIM == 3)
@@ -788,7 +817,7 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
                 if (nmodes == 1) {
                     // With only 1 mode, the angle doesn't matter so
                     // choose it randomly.
-                    theta = 2._rt*MathConst::pi*amrex::Random();
+                    theta = 2._rt*MathConst::pi*rng();
                 } else {
                     theta = 2._rt*MathConst::pi*r.y;
                 }
@@ -812,7 +841,7 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
                         continue;
                     }
 
-                    u = inj_mom->getMomentum(pos.x, pos.y, z0);
+                    u = inj_mom->getMomentum(pos.x, pos.y, z0, rng);
                     dens = inj_rho->getDensity(pos.x, pos.y, z0);
 
                     // Remove particle if density below threshold
@@ -844,7 +873,7 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
                     dens = amrex::min(dens, density_max);
 
                     // get the full momentum, including thermal motion
-                    u = inj_mom->getMomentum(pos.x, pos.y, 0._rt);
+                    u = inj_mom->getMomentum(pos.x, pos.y, 0._rt, rng);
                     const Real gamma_lab = std::sqrt( 1._rt+(u.x*u.x+u.y*u.y+u.z*u.z) );
                     const Real betaz_lab = u.z/(gamma_lab);
 
@@ -860,11 +889,11 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
 
 #ifdef WARPX_QED
                 if(loc_has_quantum_sync){
-                    p_optical_depth_QSR[ip] = quantum_sync_get_opt();
+                    p_optical_depth_QSR[ip] = quantum_sync_get_opt(rng);
                 }
 
                 if(loc_has_breit_wheeler){
-                    p_optical_depth_BW[ip] = breit_wheeler_get_opt();
+                    p_optical_depth_BW[ip] = breit_wheeler_get_opt(rng);
                 }
 #endif
 
@@ -910,8 +939,13 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
             amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
         }
         amrex::Gpu::synchronize();
+
+        new_ids.record(lev, grid_id, tile_id, particle_tile, old_size, max_new_particles);
     }
 
+    // The ids are given in the order of the tiles, whatever the number of threads
+    new_ids.assign();
+
     // The function that calls this is responsible for redistributing particles.
 }
 
@@ -1161,6 +1195,9 @@ PhysicalParticleContainer::Evolve (int lev,
     if (do_splitting && (a_dt_type == DtType::SecondHalf || a_dt_type == DtType::Full) ){
         SplitParticles(lev);
     }
+
+    // The stored fields are only valid until the particles are pushed
+    if (lev == 0) m_num_gathered.clear();
 }
 
 void
@@ -1854,23 +1891,56 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
     }
 #endif
 
+    // Fields already gathered by the ionization filter in this step:
+    // the first np_gathered particles of the tile use them
+    long np_gathered = 0;
+    const ParticleReal* AMREX_RESTRICT ex_stored = nullptr;
+    const ParticleReal* AMREX_RESTRICT ey_stored = nullptr;
+    const ParticleReal* AMREX_RESTRICT ez_stored = nullptr;
+    const ParticleReal* AMREX_RESTRICT bx_stored = nullptr;
+    const ParticleReal* AMREX_RESTRICT by_stored = nullptr;
+    const ParticleReal* AMREX_RESTRICT bz_stored = nullptr;
+    if (gather_lev == lev && ReuseIonizationGather(lev)) {
+        const auto it = m_num_gathered.find(std::make_pair(pti.index(), pti.LocalTileIndex()));
+        if (it != m_num_gathered.end()) {
+            np_gathered = it->second;
+            ex_stored = attribs[particle_comps["Ex_gathered"]].dataPtr();
+            ey_stored = attribs[particle_comps["Ey_gathered"]].dataPtr();
+            ez_stored = attribs[particle_comps["Ez_gathered"]].dataPtr();
+            bx_stored = attribs[particle_comps["Bx_gathered"]].dataPtr();
+            by_stored = attribs[particle_comps["By_gathered"]].dataPtr();
+            bz_stored = attribs[particle_comps["Bz_gathered"]].dataPtr();
+        }
+    }
+
     amrex::ParallelFor( np_to_push, [=] AMREX_GPU_DEVICE (long ip)
     {
         amrex::ParticleReal xp, yp, zp;
         getPosition(ip, xp, yp, zp);
 
         amrex::ParticleReal Exp = 0._rt, Eyp = 0._rt, Ezp = 0._rt;
-        getExternalE(ip, Exp, Eyp, Ezp);
-
         amrex::ParticleReal Bxp = 0._rt, Byp = 0._rt, Bzp = 0._rt;
-        getExternalB(ip, Bxp, Byp, Bzp);
 
-        // first gather E and B to the particle positions
-        doGatherShapeN(xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp,
-                       ex_arr, ey_arr, ez_arr, bx_arr, by_arr, bz_arr,
-                       ex_type, ey_type, ez_type, bx_type, by_type, bz_type,
-                       dx_arr, xyzmin_arr, lo, n_rz_azimuthal_modes,
-                       nox, l_lower_order_in_v);
+        if (ip + offset < np_gathered) {
+            // E and B (including the external fields) were gathered
+            // by the ionization filter at the same positions
+            Exp = ex_stored[ip+offset];
+            Eyp = ey_stored[ip+offset];
+            Ezp = ez_stored[ip+offset];
+            Bxp = bx_stored[ip+offset];
+            Byp = by_stored[ip+offset];
+            Bzp = bz_stored[ip+offset];
+        } else {
+            getExternalE(ip, Exp, Eyp, Ezp);
+            getExternalB(ip, Bxp, Byp, Bzp);
+
+            // first gather E and B to the particle positions
+            doGatherShapeN(xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp,
+                           ex_arr, ey_arr, ez_arr, bx_arr, by_arr, bz_arr,
+                           ex_type, ey_type, ez_type, bx_type, by_type, bz_type,
+                           dx_arr, xyzmin_arr, lo, n_rz_azimuthal_modes,
+                           nox, l_lower_order_in_v);
+        }
 
         scaleFields(xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp);
 
@@ -1915,6 +1985,20 @@ PhysicalParticleContainer::InitIonizationModule ()
     pp.get("physical_element", physical_element);
     // Add runtime integer component for ionization level
     AddIntComp("ionization_level");
+    pp.query("reuse_ionization_gather", m_reuse_ionization_gather);
+    if (m_reuse_ionization_gather) {
+        // The push gathers the time-averaged fields in this case
+        bool do_time_averaging = false;
+        ParmParse pp_psatd("psatd");
+        pp_psatd.query("do_time_averaging", do_time_averaging);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!do_time_averaging,
+            species_name + ".reuse_ionization_gather is not compatible with psatd.do_time_averaging");
+        // Fields gathered by the ionization filter, only used within a step
+        for (const auto& name : {"Ex_gathered", "Ey_gathered", "Ez_gathered",
+                                 "Bx_gathered", "By_gathered", "Bz_gathered"}) {
+            AddRealComp(name, false);
+        }
+    }
     // Get atomic number and ionization energies from file
     int ion_element_id = ion_map_ids[physical_element];
     ion_atomic_number = ion_atomic_numbers[ion_element_id];
@@ -1947,6 +2031,95 @@ PhysicalParticleContainer::InitIonizationModule ()
             * std::pow(2*std::pow((Uion/UH),3./2)*Ea,2*n_eff - 1);
         adk_exp_prefactor[i] = -2./3 * std::pow( Uion/UH,3./2) * Ea;
     }
+
+    // Tabulate the ADK formula, if requested
+    int table_npoints = 0;
+    Real table_tolerance = 1.e-6;
+    pp.query("ionization_table_points", table_npoints);
+    pp.query("ionization_table_tolerance", table_tolerance);
+    if (table_npoints > 0) {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(table_npoints >= 2,
+            species_name + ".ionization_table_points must be at least 2");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(table_tolerance > 0. && table_tolerance < 1.,
+            species_name + ".ionization_table_tolerance must be between 0 and 1");
+        InitADKTable(table_npoints, table_tolerance);
+    }
+}
+
+void
+PhysicalParticleContainer::InitADKTable (int npoints, Real tolerance)
+{
+    // The ionization probability of level i during one step, for a particle
+    // at rest in a field E, is 1 - exp(-w), with w given by the ADK formula
+    auto adk_w = [this] (int i, Real E) {
+        return adk_prefactor[i] * std::pow(E, adk_power[i]) * std::exp(adk_exp_prefactor[i]/E);
+    };
+
+    // The table of each level covers the fields for which
+    // tolerance < w < -log(tolerance): outside of it, the filter evaluates
+    // the ADK formula.
+    const Real w_min = tolerance;
+    const Real w_max = -std::log(tolerance);
+    adk_table_Emin.resize(ion_atomic_number);
+    adk_table_Emax.resize(ion_atomic_number);
+    adk_table_inv_dE.resize(ion_atomic_number);
+    for (int i=0; i<ion_atomic_number; ++i){
+        // w increases with E up to E_peak (beyond the validity of the formula)
+        const Real E_peak = (adk_power[i] < 0.) ?
+            adk_exp_prefactor[i]/adk_power[i] : -1.e3*adk_exp_prefactor[i];
+        // Bisection in log(E) for the field at which w reaches a given value
+        auto find_field = [&] (Real w) {
+            Real log_lo = std::log(E_peak) - 50.;
+            Real log_hi = std::log(E_peak);
+            if (adk_w(i, E_peak) <= w) return E_peak;
+            for (int k=0; k<100; ++k){
+                const Real log_mid = 0.5*(log_lo + log_hi);
+                if (adk_w(i, std::exp(log_mid)) < w) {
+                    log_lo = log_mid;
+                } else {
+                    log_hi = log_mid;
+                }
+            }
+            return std::exp(log_hi);
+        };
+        adk_table_Emin[i] = find_field(w_min);
+        adk_table_Emax[i] = find_field(w_max);
+    }
+
+    // Sample w, doubling the number of points until the error on the
+    // ionization probability at the middle of the intervals is small enough
+    const int max_npoints = std::max(npoints, 1 << 16);
+    Real error = 0.;
+    while (true) {
+        adk_table.resize(ion_atomic_number*npoints);
+        error = 0.;
+        for (int i=0; i<ion_atomic_number; ++i){
+            const Real dE = (adk_table_Emax[i] - adk_table_Emin[i])/(npoints - 1);
+            // (empty table if w never exceeds w_min)
+            adk_table_inv_dE[i] = (dE > 0.) ? 1./dE : 0.;
+            Real* table = adk_table.dataPtr() + i*npoints;
+            for (int j=0; j<npoints; ++j){
+                table[j] = adk_w(i, adk_table_Emin[i] + j*dE);
+            }
+            for (int j=0; j<npoints-1; ++j){
+                const Real w_exact = adk_w(i, adk_table_Emin[i] + (j+0.5)*dE);
+                const Real w_interp = 0.5*(table[j] + table[j+1]);
+                error = std::max(error, std::abs(std::exp(-w_interp) - std::exp(-w_exact)));
+            }
+        }
+        if (error <= tolerance || 2*npoints > max_npoints) break;
+        npoints *= 2;
+    }
+    adk_table_npoints = npoints;
+
+    if (error > tolerance) {
+        amrex::Warning("Tabulated ADK rates of species " + species_name +
+                       ": error " + std::to_string(error) +
+                       " larger than ionization_table_tolerance with " +
+                       std::to_string(npoints) + " points per ionization level");
+    }
+    amrex::Print() << "Tabulated ADK rates of species " << species_name << ": "
+                   << npoints << " points per ionization level\n";
 }
 
 IonizationFilterFunc
@@ -1962,14 +2135,54 @@ PhysicalParticleContainer::getIonizationFunc (const WarpXParIter& pti,
 {
     WARPX_PROFILE("PPC::getIonizationFunc");
 
-    return IonizationFilterFunc(pti, lev, ngE, Ex, Ey, Ez, Bx, By, Bz,
-                                v_galilean,
-                                ionization_energies.dataPtr(),
-                                adk_prefactor.dataPtr(),
-                                adk_exp_prefactor.dataPtr(),
-                                adk_power.dataPtr(),
-                                particle_icomps["ionization_level"],
-                                ion_atomic_number);
+    auto filter = IonizationFilterFunc(pti, lev, ngE, Ex, Ey, Ez, Bx, By, Bz,
+                                       v_galilean,
+                                       ionization_energies.dataPtr(),
+                                       adk_prefactor.dataPtr(),
+                                       adk_exp_prefactor.dataPtr(),
+                                       adk_power.dataPtr(),
+                                       particle_icomps["ionization_level"],
+                                       ion_atomic_number);
+    filter.m_random_tag = RandomStreamTag::Instance(RandomStreamTag::Ionization, species_id);
+
+    if (adk_table_npoints > 0) {
+        filter.m_adk_table = adk_table.dataPtr();
+        filter.m_adk_table_Emin = adk_table_Emin.dataPtr();
+        filter.m_adk_table_Emax = adk_table_Emax.dataPtr();
+        filter.m_adk_table_inv_dE = adk_table_inv_dE.dataPtr();
+        filter.m_adk_table_npoints = adk_table_npoints;
+    }
+
+    if (ReuseIonizationGather(lev)) {
+        // The filter gathers the fields of all the particles of the tile
+        // and stores them, so that PushPX does not gather them again
+        auto& attribs = pti.GetAttribs();
+        filter.m_ex_store = attribs[particle_comps["Ex_gathered"]].dataPtr();
+        filter.m_ey_store = attribs[particle_comps["Ey_gathered"]].dataPtr();
+        filter.m_ez_store = attribs[particle_comps["Ez_gathered"]].dataPtr();
+        filter.m_bx_store = attribs[particle_comps["Bx_gathered"]].dataPtr();
+        filter.m_by_store = attribs[particle_comps["By_gathered"]].dataPtr();
+        filter.m_bz_store = attribs[particle_comps["Bz_gathered"]].dataPtr();
+        const long np = pti.numParticles();
+#ifdef _OPENMP
+#pragma omp critical (warpx_ionization_gather)
+#endif
+        {
+            m_num_gathered[std::make_pair(pti.index(), pti.LocalTileIndex())] = np;
+        }
+    }
+
+    return filter;
+}
+
+bool
+PhysicalParticleContainer::ReuseIonizationGather (int lev) const
+{
+    // The push gathers the same fields as the ionization filter only
+    // without mesh refinement and without NCI corrector
+    return m_reuse_ionization_gather && lev == 0 &&
+        WarpX::GetInstance().finestLevel() == 0 &&
+        !WarpX::use_fdtd_nci_corr;
 }
 
 #ifdef WARPX_QED
@@ -0,0 +1,175 @@
+/* Copyright 2020 The WarpX Community
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "SortingUtils.H"
+#include "Particles/WarpXParticleContainer.H"
+#include "WarpX.H"
+
+#include <AMReX_Particles.H>
+
+#include <utility>
+
+
+using namespace amrex;
+
+/* \brief Sort the particles of each tile by bin
+ *
+ * The particles are sorted with a counting sort on the bin indices, which
+ * keeps the order of the particles within a bin on CPU. The resulting
+ * permutation is then applied to the particle AoS, and to each real and
+ * integer component (including the runtime components) in turn, through
+ * a single temporary array of the size of a component.
+ *
+ * \param bin_size number of cells of a bin in each direction
+ */
+void
+WarpXParticleContainer::SortParticlesByBin (amrex::IntVect bin_size)
+{
+    WARPX_PROFILE("WPC::SortParticlesByBin()");
+
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        const Geometry& geom = Geom(lev);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            const long np = pti.numParticles();
+            if (np == 0) continue;
+
+            auto& aos = pti.GetArrayOfStructs();
+            auto& soa = pti.GetStructOfArrays();
+
+            const getParticleBinIndex get_bin( aos().dataPtr(), pti.tilebox(),
+                                               bin_size, geom, WarpX::sort_bin_order );
+            const int nbins = get_bin.numBins();
+
+            // Find the bin of each particle, and count the particles in each bin
+            Gpu::DeviceVector<int> bin_index;
+            bin_index.resize(np);
+            Gpu::DeviceVector<int> counts;
+            counts.resize(nbins+1);
+            Gpu::DeviceVector<int> offsets;
+            offsets.resize(nbins+1);
+            int* const AMREX_RESTRICT pbin = bin_index.dataPtr();
+            int* const AMREX_RESTRICT pcounts = counts.dataPtr();
+            int* const AMREX_RESTRICT poffsets = offsets.dataPtr();
+            amrex::ParallelFor( nbins+1,
+                [=] AMREX_GPU_DEVICE (int i) noexcept { pcounts[i] = 0; });
+            amrex::ParallelFor( np,
+                [=] AMREX_GPU_DEVICE (long i) noexcept
+                {
+                    pbin[i] = get_bin(i);
+                    Gpu::Atomic::Add( &pcounts[pbin[i]], 1 );
+                });
+            Gpu::exclusive_scan(counts.begin(), counts.end(), offsets.begin());
+
+            // Find the indices that reorder the particles by bin
+            Gpu::DeviceVector<long> pid;
+            pid.resize(np);
+            long* const AMREX_RESTRICT ppid = pid.dataPtr();
+            amrex::ParallelFor( np,
+                [=] AMREX_GPU_DEVICE (long i) noexcept
+                {
+                    const int dst = Gpu::Atomic::Add( &poffsets[pbin[i]], 1 );
+                    ppid[dst] = i;
+                });
+
+            // Reorder the particle AoS
+            {
+                ParticleVector particle_tmp;
+                particle_tmp.resize(np);
+                amrex::ParallelFor( np,
+                    copyAndReorder<ParticleType>( aos(), particle_tmp, pid ) );
+                std::swap(aos(), particle_tmp);
+                // Make sure that the temporary array is not destroyed before
+                // the GPU kernels finish running
+                Gpu::streamSynchronize();
+            }
+
+            // Reorder the particle attributes, one at a time
+            {
+                RealVector tmp;
+                tmp.resize(np);
+                for (int comp = 0; comp < NumRealComps(); ++comp) {
+                    auto& attrib = soa.GetRealData(comp);
+                    amrex::ParallelFor( np,
+                        copyAndReorder<ParticleReal>( attrib, tmp, pid ) );
+                    std::swap(attrib, tmp);
+                }
+                Gpu::streamSynchronize();
+            }
+            if (NumIntComps() > 0)
+            {
+                IntVector tmp;
+                tmp.resize(np);
+                for (int comp = 0; comp < NumIntComps(); ++comp) {
+                    auto& attrib = soa.GetIntData(comp);
+                    amrex::ParallelFor( np,
+                        copyAndReorder<int>( attrib, tmp, pid ) );
+                    std::swap(attrib, tmp);
+                }
+                Gpu::streamSynchronize();
+            }
+        }
+    }
+}
+
+/* \brief Count the particles that are in the same bin as the previous
+ * particle of their tile, as a measure of the locality of the particles
+ * in memory (used to decide when to sort them again)
+ *
+ * \param bin_size number of cells of a bin in each direction
+ * \param num_same_bin incremented by the number of such particles
+ * \param num_particles incremented by the number of particles
+ */
+void
+WarpXParticleContainer::CountParticlesInSameBin (amrex::IntVect bin_size,
+                                                 long& num_same_bin, long& num_particles)
+{
+    WARPX_PROFILE("WPC::CountParticlesInSameBin()");
+
+    long local_same_bin = 0;
+    long local_particles = 0;
+
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        const Geometry& geom = Geom(lev);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion()) reduction(+:local_same_bin,local_particles)
+#endif
+        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            const long np = pti.numParticles();
+            if (np < 2) {
+                local_particles += np;
+                continue;
+            }
+
+            const getParticleBinIndex get_bin( pti.GetArrayOfStructs()().dataPtr(),
+                                               pti.tilebox(), bin_size, geom,
+                                               WarpX::sort_bin_order );
+
+            Gpu::ManagedDeviceVector<int> count(1, 0);
+            int* const AMREX_RESTRICT pcount = count.dataPtr();
+            amrex::ParallelFor( np-1,
+                [=] AMREX_GPU_DEVICE (long i) noexcept
+                {
+                    if (get_bin(i+1) == get_bin(i)) Gpu::Atomic::Add( pcount, 1 );
+                });
+            Gpu::synchronize();
+
+            local_same_bin += pcount[0];
+            local_particles += np;
+        }
+    }
+
+    num_same_bin += local_same_bin;
+    num_particles += local_particles;
+}
@@ -495,7 +495,8 @@ WarpXParticleContainer::DepositCharge (WarpXParIter& pti, RealVector& wp,
 void
 WarpXParticleContainer::DepositCharge (amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
                                         bool local, bool reset,
-                                        bool do_rz_volume_scaling)
+                                        bool do_rz_volume_scaling,
+                                        bool interpolate_across_levels)
 {
 #ifdef WARPX_DIM_RZ
     (void)do_rz_volume_scaling;
@@ -545,6 +546,7 @@ WarpXParticleContainer::DepositCharge (amrex::Vector<std::unique_ptr<amrex::Mult
 
     // Now that the charge has been deposited at each level,
     // we average down from fine to crse
+    if (!interpolate_across_levels) return;
     for (int lev = finest_level - 1; lev >= 0; --lev) {
         const DistributionMapping& fine_dm = rho[lev+1]->DistributionMap();
         BoxArray coarsened_fine_BA = rho[lev+1]->boxArray();
@@ -611,6 +613,75 @@ WarpXParticleContainer::GetChargeDensity (int lev, bool local)
     return rho;
 }
 
+std::unique_ptr<MultiFab>
+WarpXParticleContainer::GetChargeDensity (int lev, const Box& region, bool local)
+{
+    const auto& gm = m_gdb->Geom(lev);
+    const auto& ba = m_gdb->ParticleBoxArray(lev);
+    const auto& dm = m_gdb->DistributionMap(lev);
+
+    const int ng = WarpX::nox;
+
+    // Particles deposit up to ng nodes outside of their grid: only the grids
+    // within ng nodes of the region are allocated and deposited.
+    const Box nodal_region = amrex::surroundingNodes(region);
+    BoxList bl;
+    Vector<int> deposit_grid(ba.size(), 0);
+    for (int i = 0; i < ba.size(); ++i) {
+        const Box nbx = amrex::surroundingNodes(ba[i]);
+        if (amrex::grow(nbx, ng).intersects(nodal_region)) {
+            bl.push_back(nbx);
+            deposit_grid[i] = 1;
+        } else {
+            bl.push_back(Box(nbx.smallEnd(), nbx.smallEnd(), nbx.ixType()));
+        }
+    }
+
+    auto rho = std::unique_ptr<MultiFab>(new MultiFab(BoxArray(std::move(bl)),dm,WarpX::ncomps,ng));
+    rho->setVal(0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+    {
+#endif
+#ifdef _OPENMP
+        int thread_num = omp_get_thread_num();
+#else
+        int thread_num = 0;
+#endif
+
+        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            if (!deposit_grid[pti.index()]) continue;
+            const Box tbx = amrex::convert(pti.tilebox(), IntVect::TheNodeVector());
+            if (!amrex::grow(tbx, ng).intersects(nodal_region)) continue;
+
+            const long np = pti.numParticles();
+            auto& wp = pti.GetAttribs(PIdx::w);
+
+            int* AMREX_RESTRICT ion_lev;
+            if (do_field_ionization){
+                ion_lev = pti.GetiAttribs(particle_icomps["ionization_level"]).dataPtr();
+            } else {
+                ion_lev = nullptr;
+            }
+
+            DepositCharge(pti, wp, ion_lev, rho.get(), 0, 0, np,
+                          thread_num, lev, lev);
+        }
+#ifdef _OPENMP
+    }
+#endif
+
+#ifdef WARPX_DIM_RZ
+    WarpX::GetInstance().ApplyInverseVolumeScalingToChargeDensity(rho.get(), lev);
+#endif
+
+    if (!local) rho->SumBoundary(gm.periodicity());
+
+    return rho;
+}
+
 Real WarpXParticleContainer::sumParticleCharge(bool local) {
 
     amrex::Real total_charge = 0.0;
@@ -833,6 +904,72 @@ void WarpXParticleContainer::defineAllParticleTiles () noexcept
     }
 }
 
+void
+WarpXParticleContainer::BuildCellBins (int lev)
+{
+    WARPX_PROFILE("WPC::BuildCellBins()");
+
+    if (m_cell_bins.size() <= lev) {
+        m_cell_bins.resize(lev+1);
+        m_cell_bins_built.resize(lev+1, 0);
+    }
+    if (m_cell_bins_built[lev]) return;
+
+    // Create the tiles and the map entries in serial, so that
+    // the maps are not modified in the parallel loop
+    defineAllParticleTiles();
+    auto& bins_map = m_cell_bins[lev];
+    bins_map.clear();
+    MFItInfo info;
+    if (Gpu::notInLaunchRegion()) info.EnableTiling(tile_size);
+    for (MFIter mfi = MakeMFIter(lev, info); mfi.isValid(); ++mfi) {
+        bins_map[std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+    }
+
+    Geometry const& geom = WarpX::GetInstance().Geom(lev);
+
+#ifdef _OPENMP
+    info.SetDynamic(true);
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi = MakeMFIter(lev, info); mfi.isValid(); ++mfi)
+    {
+        auto& ptile = ParticlesAt(lev, mfi);
+        int const np = ptile.numParticles();
+        ParticleType const* particle_ptr = ptile.GetArrayOfStructs()().data();
+
+        Box const& cbx = mfi.tilebox(IntVect::TheZeroVector()); //Cell-centered box
+        const IntVect lo = cbx.smallEnd();
+        const GetParticleCellAndOffset getCell(particle_ptr, geom);
+
+        // Find particles that are in each cell;
+        // results are stored in the bins of this tile.
+        auto& bins = bins_map.at(std::make_pair(mfi.index(), mfi.LocalTileIndex()));
+        bins.build(np, particle_ptr, cbx,
+            // Pass lambda function that returns the cell index
+            [=] AMREX_GPU_HOST_DEVICE (const ParticleType& p) noexcept -> IntVect
+            {
+                return getCell(&p - particle_ptr) - lo;
+            });
+    }
+
+    m_cell_bins_built[lev] = 1;
+}
+
+WarpXParticleContainer::ParticleBins&
+WarpXParticleContainer::GetCellBins (int lev, const MFIter& mfi)
+{
+    AMREX_ASSERT(lev < m_cell_bins_built.size() && m_cell_bins_built[lev]);
+    return m_cell_bins[lev].at(std::make_pair(mfi.index(), mfi.LocalTileIndex()));
+}
+
+void
+WarpXParticleContainer::InvalidateCellBins ()
+{
+    m_cell_bins.clear();
+    m_cell_bins_built.clear();
+}
+
 // This function is called in Redistribute, just after locate
 void
 WarpXParticleContainer::particlePostLocate(ParticleType& p,
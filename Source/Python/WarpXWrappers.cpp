@@ -316,7 +316,7 @@ extern "C"
     amrex::Real** FIELD(int lev, int direction, \
                         int *return_size, int *ncomps, int *ngrow, int **shapes) { \
         auto * pml = WarpX::GetInstance().GetPML(lev); \
-        if (pml) { \
+        if (pml && pml->GETTER()[direction]) { \
             auto & mf = *(pml->GETTER()[direction]); \
             return getMultiFabPointers(mf, return_size, ncomps, ngrow, shapes); \
         } else { \
@@ -328,7 +328,7 @@ extern "C"
     int* FIELD(int lev, int direction, \
                int *return_size, int *ngrow) { \
         auto * pml = WarpX::GetInstance().GetPML(lev); \
-        if (pml) { \
+        if (pml && pml->GETTER()[direction]) { \
             auto & mf = *(pml->GETTER()[direction]); \
             return getMultiFabLoVects(mf, return_size, ngrow); \
         } else { \
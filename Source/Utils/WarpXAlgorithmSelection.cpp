@@ -70,6 +70,21 @@ const std::map<std::string, int> MacroscopicSolver_algo_to_int = {
     {"default", MacroscopicSolverAlgo::BackwardEuler},
 };
 
+const std::map<std::string, int> spectral_filter_to_int = {
+    {"none",                  SpectralFilterType::None },
+    {"bilinear",              SpectralFilterType::Bilinear },
+    {"gaussian",              SpectralFilterType::Gaussian },
+    {"cutoff",                SpectralFilterType::Cutoff },
+    {"parse_filter_function", SpectralFilterType::ParserFunction },
+    {"default",               SpectralFilterType::None }
+};
+
+const std::map<std::string, int> sort_bin_order_to_int = {
+    {"linear",  SortBinOrder::Linear },
+    {"morton",  SortBinOrder::Morton },
+    {"default", SortBinOrder::Linear }
+};
+
 int
 GetAlgorithmInteger( amrex::ParmParse& pp, const char* pp_search_key ){
 
@@ -97,6 +112,10 @@ GetAlgorithmInteger( amrex::ParmParse& pp, const char* pp_search_key ){
         algo_to_int = MaxwellSolver_medium_algo_to_int;
     } else if (0 == std::strcmp(pp_search_key, "macroscopic_sigma_method")) {
         algo_to_int = MacroscopicSolver_algo_to_int;
+    } else if (0 == std::strcmp(pp_search_key, "spectral_filter")) {
+        algo_to_int = spectral_filter_to_int;
+    } else if (0 == std::strcmp(pp_search_key, "sort_bin_order")) {
+        algo_to_int = sort_bin_order_to_int;
     } else {
         std::string pp_search_string = pp_search_key;
         amrex::Abort("Unknown algorithm type: " + pp_search_string);
@@ -67,6 +67,9 @@ WarpX::MoveWindow (bool move_j)
 
     if (num_shift_base == 0) return 0;
 
+    // All fields are shifted below
+    guard_cells.SetAllStale();
+
     // update the problem domain. Note the we only do this on the base level because
     // amrex::Geometry objects share the same, static RealBox.
     for (int i=0; i<AMREX_SPACEDIM; i++) {
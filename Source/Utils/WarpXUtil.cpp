@@ -14,6 +14,9 @@
 #include <cmath>
 #include <fstream>
 
+#include <dirent.h>
+#include <sys/stat.h>
+
 
 using namespace amrex;
 
@@ -176,6 +179,24 @@ namespace WarpXUtilIO{
         of.close();
         return  of.good();
     }
+
+    long GetPathSize(std::string const& path)
+    {
+        struct stat st;
+        if (lstat(path.c_str(), &st) != 0) return 0;
+        if (!S_ISDIR(st.st_mode)) return static_cast<long>(st.st_size);
+
+        long size = 0;
+        DIR* dir = opendir(path.c_str());
+        if (dir == nullptr) return 0;
+        while (struct dirent* entry = readdir(dir)) {
+            std::string const name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            size += GetPathSize(path + "/" + name);
+        }
+        closedir(dir);
+        return size;
+    }
 }
 
 void Store_parserString(amrex::ParmParse& pp, std::string query_string,
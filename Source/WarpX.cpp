@@ -83,13 +83,18 @@ bool WarpX::use_fdtd_nci_corr = false;
 int  WarpX::l_lower_order_in_v = true;
 
 bool WarpX::use_filter        = false;
+bool WarpX::use_spectral_filter = false;
 bool WarpX::serialize_ics     = false;
 bool WarpX::refine_plasma     = false;
 
 int WarpX::num_mirrors = 0;
 
+unsigned int WarpX::random_stream_seed = 1;
+
 IntervalsParser WarpX::sort_intervals;
 amrex::IntVect WarpX::sort_bin_size(AMREX_D_DECL(4,4,4));
+int WarpX::sort_bin_order;
+amrex::Real WarpX::sort_locality_threshold = 0.;
 
 bool WarpX::do_back_transformed_diagnostics = false;
 std::string WarpX::lab_data_directory = "lab_frame_data";
@@ -105,8 +110,10 @@ Real WarpX::particle_slice_width_lab = 0.0;
 bool WarpX::do_dynamic_scheduling = true;
 
 int WarpX::do_electrostatic = 0;
+int WarpX::do_persistent_phi = 1;
 int WarpX::do_subcycling = 0;
 bool WarpX::safe_guard_cells = 0;
+bool WarpX::lazy_guard_cell_exchange = false;
 
 IntVect WarpX::filter_npass_each_dir(1);
 
@@ -217,6 +224,9 @@ WarpX::WarpX ()
     current_buf.resize(nlevs_max);
     charge_buf.resize(nlevs_max);
 
+    rho_es_fp.resize(nlevs_max);
+    phi_fp.resize(nlevs_max);
+
     pml.resize(nlevs_max);
     costs.resize(nlevs_max);
 
@@ -319,6 +329,7 @@ WarpX::ReadParameters ()
         ParmParse pp("amr");// Traditionally, these have prefix, amr.
 
         pp.query("restart", restart_chkfile);
+        pp.query("restart_new_decomposition", restart_new_decomposition);
     }
 
     {
@@ -332,11 +343,16 @@ WarpX::ReadParameters ()
             if ( random_seed == "random" ) {
                 std::random_device rd;
                 std::uniform_int_distribution<int> dist(2, INT_MAX);
-                unsigned long seed = myproc_1 * dist(rd);
+                int stream_seed = dist(rd);
+                unsigned long seed = myproc_1 * stream_seed;
                 ResetRandomSeed(seed);
+                // The counter-based random streams use the same seed on all ranks
+                ParallelDescriptor::Bcast(&stream_seed, 1, ParallelDescriptor::IOProcessorNumber());
+                random_stream_seed = stream_seed;
             } else if ( std::stoi(random_seed) > 0 ) {
                 unsigned long seed = myproc_1 * std::stoul(random_seed);
                 ResetRandomSeed(seed);
+                random_stream_seed = std::stoul(random_seed);
             } else {
                 Abort("warpx.random_seed must be \"default\", \"random\" or an integer > 0.");
             }
@@ -348,6 +364,7 @@ WarpX::ReadParameters ()
         pp.query("do_subcycling", do_subcycling);
         pp.query("use_hybrid_QED", use_hybrid_QED);
         pp.query("safe_guard_cells", safe_guard_cells);
+        pp.query("lazy_guard_cell_exchange", lazy_guard_cell_exchange);
         std::string override_sync_int_string = "1";
         pp.query("override_sync_int", override_sync_int_string);
         override_sync_intervals = IntervalsParser(override_sync_int_string);
@@ -435,6 +452,7 @@ WarpX::ReadParameters ()
         }
 
         pp.query("do_electrostatic", do_electrostatic);
+        pp.query("do_persistent_phi", do_persistent_phi);
         pp.query("n_buffer", n_buffer);
         pp.query("const_dt", const_dt);
 
@@ -478,6 +496,8 @@ WarpX::ReadParameters ()
             for (int i=0; i<AMREX_SPACEDIM; i++)
                 sort_bin_size[i] = vect_sort_bin_size[i];
         }
+        sort_bin_order = GetAlgorithmInteger(pp, "sort_bin_order");
+        pp.query("sort_locality_threshold", sort_locality_threshold);
 
         double quantum_xi;
         int quantum_xi_is_specified = pp.query("quantum_xi", quantum_xi);
@@ -615,6 +635,12 @@ WarpX::ReadParameters ()
         pp.query("update_with_rho", update_with_rho);
         pp.query("v_galilean", v_galilean);
         pp.query("do_time_averaging", fft_do_time_averaging);
+        use_spectral_filter =
+            (GetAlgorithmInteger(pp, "spectral_filter") != SpectralFilterType::None);
+#   ifdef WARPX_DIM_RZ
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!use_spectral_filter,
+            "psatd.spectral_filter is not implemented in RZ geometry");
+#   endif
       // Scale the velocity by the speed of light
         for (int i=0; i<3; i++) v_galilean[i] *= PhysConst::c;
     }
@@ -733,6 +759,10 @@ WarpX::ClearLevel (int lev)
     F_cp  [lev].reset();
     rho_cp[lev].reset();
 
+    rho_es_fp[lev].reset();
+    phi_fp   [lev].reset();
+    ResetPoissonSolver();
+
     costs[lev].reset();
 }
 
@@ -755,7 +785,8 @@ WarpX::AllocLevelData (int lev, const BoxArray& ba, const DistributionMapping& d
         maxwell_fdtd_solver_id,
         maxLevel(),
         WarpX::v_galilean,
-        safe_guard_cells);
+        safe_guard_cells,
+        lazy_guard_cell_exchange);
 
     if (mypc->nSpeciesDepositOnMainGrid() && n_current_deposition_buffer == 0) {
         n_current_deposition_buffer = 1;
@@ -881,6 +912,15 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
         rho_fp[lev].reset(new MultiFab(amrex::convert(ba,rho_nodal_flag),dm,2*ncomps,ngRho));
     }
 
+    if (do_electrostatic)
+    {
+        // Total charge density and potential of the electrostatic solver
+        BoxArray const nba = amrex::convert(ba,IntVect::TheNodeVector());
+        rho_es_fp[lev].reset(new MultiFab(nba,dm,1,WarpX::nox));
+        phi_fp[lev].reset(new MultiFab(nba,dm,1,1));
+        phi_fp[lev]->setVal(0.);
+    }
+
     if (do_subcycling == 1 && lev == 0)
     {
         current_store[lev][0].reset( new MultiFab(amrex::convert(ba,jx_nodal_flag),dm,ncomps,ngJ));
@@ -0,0 +1,118 @@
+# Copyright 2020 The WarpX Community
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+import argparse
+import sys
+import numpy as np
+
+'''
+This script checks the round trip of reduced output (single precision
+and/or compression, see the parameters <diag_name>.output_precision and
+<diag_name>.openpmd_compression): it compares a dump written with data
+reduction to the same dump written without, field by field and particle
+record by particle record, and prints the maximum absolute and relative
+errors.
+
+Plotfiles are read with yt, openPMD series with openpmd_api.
+
+> python compare_reduced_output.py --reference diags/ref000100 --reduced diags/red000100
+> python compare_reduced_output.py --reference diags/ref/openpmd_%T.bp \
+      --reduced diags/red/openpmd_%T.bp --iteration 100
+
+The script exits with a non-zero status if a relative error is larger than
+the tolerance given by --rtol.
+'''
+
+def read_plotfile(path):
+    import yt
+    yt.funcs.mylog.setLevel(50)
+    ds = yt.load(path)
+    grid = ds.covering_grid(level=0, left_edge=ds.domain_left_edge,
+                            dims=ds.domain_dimensions)
+    all_data = ds.all_data()
+    data = {}
+    for field_type, field_name in ds.field_list:
+        if field_type == 'boxlib':
+            data[field_name] = np.array(grid[field_type, field_name])
+        else:
+            # particle quantities: sort by id to compare the same particles
+            order = np.argsort(np.array(all_data[field_type, 'particle_id']))
+            data[field_type + '/' + field_name] = \
+                np.array(all_data[field_type, field_name])[order]
+    return data
+
+def read_openpmd(path, iteration):
+    import openpmd_api as io
+    series = io.Series(path, io.Access.read_only)
+    it = series.iterations[iteration]
+    loaded = {}
+    for name, mesh in it.meshes.items():
+        for comp_name, comp in mesh.items():
+            loaded['fields/' + name + '/' + comp_name] = comp.load_chunk()
+    ids = {}
+    for species_name, species in it.particles.items():
+        ids[species_name] = species['id'][io.Mesh_Record_Component.SCALAR].load_chunk()
+        for record_name, record in species.items():
+            if record_name == 'id':
+                continue
+            for comp_name, comp in record.items():
+                if comp.constant:
+                    continue
+                key = species_name + '/' + record_name + '/' + comp_name
+                loaded[key] = (species_name, comp.load_chunk())
+    series.flush()
+    data = {}
+    for key, value in loaded.items():
+        if isinstance(value, tuple):
+            # sort by id to compare the same particles
+            species_name, array = value
+            data[key] = array[np.argsort(ids[species_name])]
+        else:
+            data[key] = value
+    return data
+
+def read(path, iteration):
+    if iteration is None:
+        return read_plotfile(path)
+    return read_openpmd(path, iteration)
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare reduced output to a reference')
+    parser.add_argument('--reference', required=True,
+                        help='plotfile or openPMD series written without data reduction')
+    parser.add_argument('--reduced', required=True,
+                        help='plotfile or openPMD series written with data reduction')
+    parser.add_argument('--iteration', type=int, default=None,
+                        help='iteration to compare (openPMD only)')
+    parser.add_argument('--rtol', type=float, default=1.e-6,
+                        help='maximum relative error (relative to the max of each record)')
+    args = parser.parse_args()
+
+    reference = read(args.reference, args.iteration)
+    reduced = read(args.reduced, args.iteration)
+
+    success = True
+    for key in sorted(reference.keys()):
+        if key not in reduced:
+            print('%s: missing in reduced output' %key)
+            success = False
+            continue
+        ref = np.asarray(reference[key], dtype=np.float64)
+        red = np.asarray(reduced[key], dtype=np.float64)
+        if ref.shape != red.shape:
+            print('%s: shapes differ %s %s' %(key, ref.shape, red.shape))
+            success = False
+            continue
+        if ref.size == 0:
+            continue
+        abs_err = np.max(np.abs(red - ref))
+        scale = np.max(np.abs(ref))
+        rel_err = abs_err / scale if scale > 0 else abs_err
+        print('%s: max abs error %e, max rel error %e' %(key, abs_err, rel_err))
+        if rel_err > args.rtol:
+            success = False
+
+    sys.exit(0 if success else 1)
@@ -0,0 +1,42 @@
+#! /usr/bin/env python
+
+# Copyright 2020 The WarpX Community
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+"""
+Read the iterations streamed by a WarpX diagnostic with
+<diag_name>.openpmd_backend = sst, while the simulation is running.
+
+Start the simulation, then run this script from another process
+(on the same node or not), e.g.
+
+    python read_openpmd_stream.py diags/diag1/openpmd.sst
+
+The reader waits for the simulation to open the stream, then prints the
+maximum of Ex at each streamed iteration, until the simulation ends.
+Requires the Python bindings of openPMD-api >= 0.12, with ADIOS2 support.
+"""
+
+import sys
+import numpy as np
+import openpmd_api as io
+
+def read_stream(path, field='E', component='x'):
+    """
+    Yield the iteration number and the data of one field component,
+    for each iteration of the stream.
+    """
+    series = io.Series(path, io.Access_Type.read_only)
+    for iteration in series.read_iterations():
+        data = iteration.meshes[field][component].load_chunk()
+        # The data is only available once the iteration is closed,
+        # which also releases the step of the writer
+        iteration.close()
+        yield iteration.iteration_index, data
+
+if __name__ == "__main__":
+    for index, data in read_stream(sys.argv[1]):
+        print("iteration %d: max |Ex| = %g" %(index, np.max(np.abs(data))))
@@ -330,6 +330,40 @@ def read_reduced_diags(filename, delimiter=' '):
     metadata_dict['column'] = {key: field_column[i] for i, key in enumerate(field_names)}
     return metadata_dict, data_dict
 
+def read_reduced_diags_binary(filename, delimiter=' '):
+    '''
+    Read data written by WarpX Reduced Diagnostics with <reduced_diags_name>.format = binary,
+    and return them into the same Python objects as read_reduced_diags
+    input:
+    - filename name of file to open
+    - delimiter (optional, default ' ') delimiter between fields in header.
+    output:
+    - metadata_dict dictionary where first key is the type of metadata, second is the field
+    - data dictionary with data
+    '''
+    with open(filename, 'rb') as f:
+        # Read header line
+        unformatted_header = f.readline().decode().strip().split(delimiter)
+        # Read the blocks of rows, stored column by column
+        blocks = []
+        while True:
+            sizes = np.fromfile(f, 'int32', 2)
+            if sizes.size < 2:
+                break
+            nrows, ncols = sizes
+            blocks.append(np.fromfile(f, 'float64', nrows*ncols).reshape((ncols, nrows)))
+    data = np.concatenate(blocks, axis=1)
+    # From header line, get field name, units and column number
+    field_names =  [s[s.find("]")+1:s.find("(")] for s in unformatted_header]
+    field_units =  [s[s.find("(")+1:s.find(")")] for s in unformatted_header]
+    field_column =  [s[s.find("[")+1:s.find("]")] for s in unformatted_header]
+    data_dict = {key: data[i,:] for i, key in enumerate(field_names)}
+    # Put header data into a dictionary
+    metadata_dict = {}
+    metadata_dict['units'] = {key: field_units[i] for i, key in enumerate(field_names)}
+    metadata_dict['column'] = {key: field_column[i] for i, key in enumerate(field_names)}
+    return metadata_dict, data_dict
+
 def read_reduced_diags_histogram(filename, delimiter=' '):
     '''
     Modified based on read_reduced_diags